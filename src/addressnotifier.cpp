@@ -0,0 +1,76 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addressnotifier.h>
+
+std::unique_ptr<AddressDeltaNotifier> g_address_notifier;
+
+bool AddressDeltaNotifier::Watch(int type, const uint256& hash)
+{
+    LOCK(m_mutex);
+    if (!m_watched.insert(IndexedAddress{type, hash}).second) return false;
+    m_watched_count = m_watched.size();
+    return true;
+}
+
+bool AddressDeltaNotifier::Unwatch(int type, const uint256& hash)
+{
+    LOCK(m_mutex);
+    if (m_watched.erase(IndexedAddress{type, hash}) == 0) return false;
+    m_watched_count = m_watched.size();
+    return true;
+}
+
+void AddressDeltaNotifier::Notify(std::vector<AddressDeltaEvent>&& events)
+{
+    {
+        LOCK(m_mutex);
+        bool logged{false};
+        for (AddressDeltaEvent& event : events) {
+            if (m_watched.count(IndexedAddress{event.type, event.address_hash}) == 0) continue;
+            event.sequence = ++m_sequence;
+            m_events.push_back(std::move(event));
+            logged = true;
+        }
+        if (!logged) return;
+        while (m_events.size() > m_max_events) {
+            m_events.pop_front();
+        }
+    }
+    m_cv.notify_all();
+}
+
+uint64_t AddressDeltaNotifier::GetEventsLocked(uint64_t after, size_t limit, std::vector<AddressDeltaEvent>& events) const
+{
+    AssertLockHeld(m_mutex);
+    // Sequence numbers are consecutive, so the first event to return is
+    // found by its offset from the oldest one.
+    if (!m_events.empty() && after < m_sequence) {
+        const uint64_t first{m_events.front().sequence};
+        auto it{m_events.begin() + (after < first ? 0 : after - first + 1)};
+        for (; it != m_events.end() && limit > 0; ++it, --limit) {
+            events.push_back(*it);
+        }
+    }
+    return m_sequence;
+}
+
+uint64_t AddressDeltaNotifier::GetEvents(uint64_t after, size_t limit, std::vector<AddressDeltaEvent>& events) const
+{
+    LOCK(m_mutex);
+    return GetEventsLocked(after, limit, events);
+}
+
+uint64_t AddressDeltaNotifier::WaitForEvents(uint64_t after, size_t limit, std::chrono::milliseconds timeout, std::vector<AddressDeltaEvent>& events) const
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait_for(lock, timeout, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_sequence > after || m_interrupted; });
+    return GetEventsLocked(after, limit, events);
+}
+
+void AddressDeltaNotifier::Interrupt()
+{
+    WITH_LOCK(m_mutex, m_interrupted = true);
+    m_cv.notify_all();
+}
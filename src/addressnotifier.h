@@ -0,0 +1,112 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_ADDRESSNOTIFIER_H
+#define BITCOIN_ADDRESSNOTIFIER_H
+
+#include <consensus/amount.h>
+#include <mempoolindex.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+/** Number of address delta events kept for readers that fall behind. */
+static constexpr size_t DEFAULT_ADDRESS_DELTA_EVENTS{100000};
+
+/** An address index entry of a watched address, as pushed to subscribers. */
+struct AddressDeltaEvent
+{
+    enum Status : uint8_t {
+        MEMPOOL = 0,      //!< the transaction entered the mempool
+        CONNECTED = 1,    //!< the transaction is in a block connected at `height`
+        DISCONNECTED = 2, //!< the block at `height` was disconnected again
+    };
+
+    uint64_t sequence{0};
+    uint8_t status{MEMPOOL};
+    int type{0};
+    uint256 address_hash;
+    uint256 txid;
+    uint32_t index{0};
+    bool spending{false};
+    CAmount satoshis{0};
+    int height{-1};
+
+    AddressDeltaEvent() = default;
+    AddressDeltaEvent(Status status_in, int type_in, const uint256& address_hash_in, const uint256& txid_in,
+                      uint32_t index_in, bool spending_in, CAmount satoshis_in, int height_in)
+        : status{status_in}, type{type_in}, address_hash{address_hash_in}, txid{txid_in},
+          index{index_in}, spending{spending_in}, satoshis{satoshis_in}, height{height_in} {}
+
+    SERIALIZE_METHODS(AddressDeltaEvent, obj)
+    {
+        READWRITE(obj.sequence, obj.status, obj.type, obj.address_hash, obj.txid, obj.index, obj.spending, obj.satoshis, obj.height);
+    }
+};
+
+/**
+ * Push notifications for a registered set of addresses.
+ *
+ * The mempool and the insight index hand every address delta they index to
+ * Notify, which keeps those of watched addresses in a bounded log with
+ * increasing sequence numbers. ZMQ publishers and REST long-polls read the
+ * log from the last sequence number they saw, so clients no longer need to
+ * poll the address index for each of their addresses.
+ */
+class AddressDeltaNotifier
+{
+public:
+    explicit AddressDeltaNotifier(size_t max_events = DEFAULT_ADDRESS_DELTA_EVENTS) : m_max_events{max_events} {}
+
+    /** Start reporting deltas of an address. Returns false if it was already watched. */
+    bool Watch(int type, const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Stop reporting deltas of an address. Returns false if it was not watched. */
+    bool Unwatch(int type, const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    size_t WatchedCount() const { return m_watched_count.load(std::memory_order_relaxed); }
+    /** Whether any address is watched, so producers can skip building events. */
+    bool IsWatching() const { return WatchedCount() > 0; }
+
+    /** Log the events of watched addresses and wake up waiting readers. */
+    void Notify(std::vector<AddressDeltaEvent>&& events) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Append logged events with a sequence number above `after`, at most
+     * `limit` of them. Events that dropped out of the log are skipped, which
+     * readers see as a gap in the sequence numbers.
+     *
+     * @returns the sequence number of the last logged event
+     */
+    uint64_t GetEvents(uint64_t after, size_t limit, std::vector<AddressDeltaEvent>& events) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** GetEvents, first waiting up to `timeout` for an event after `after`. */
+    uint64_t WaitForEvents(uint64_t after, size_t limit, std::chrono::milliseconds timeout, std::vector<AddressDeltaEvent>& events) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wake up waiting readers and stop waiting in WaitForEvents. */
+    void Interrupt() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    uint64_t GetEventsLocked(uint64_t after, size_t limit, std::vector<AddressDeltaEvent>& events) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    const size_t m_max_events;
+    mutable Mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    std::unordered_set<IndexedAddress, SaltedAddressHasher> m_watched GUARDED_BY(m_mutex);
+    std::atomic<size_t> m_watched_count{0};
+    std::deque<AddressDeltaEvent> m_events GUARDED_BY(m_mutex);
+    uint64_t m_sequence GUARDED_BY(m_mutex){0};
+    bool m_interrupted GUARDED_BY(m_mutex){false};
+};
+
+/** Set when -addressindex is enabled. */
+extern std::unique_ptr<AddressDeltaNotifier> g_address_notifier;
+
+#endif // BITCOIN_ADDRESSNOTIFIER_H
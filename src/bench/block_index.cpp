@@ -0,0 +1,126 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <memusage.h>
+#include <node/blockstorage.h>
+#include <node/powhashcache.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+using node::BlockMap;
+using node::PoWHashCache;
+
+static constexpr size_t NUM_BLOCK_INDEX_ENTRIES{10'000};
+
+namespace {
+/** A chain of index entries on top of the genesis block, as they would be written to the block tree. */
+struct BlockIndexChain {
+    std::deque<uint256> hashes;
+    std::deque<CBlockIndex> entries;
+
+    explicit BlockIndexChain(const CBlock& genesis)
+    {
+        CBlockHeader header{genesis.GetBlockHeader()};
+        for (size_t i = 0; i < NUM_BLOCK_INDEX_ENTRIES; ++i) {
+            if (i > 0) {
+                header.hashPrevBlock = hashes.back();
+                header.nTime += 5;
+            }
+            hashes.push_back(header.GetHash());
+            CBlockIndex& index{entries.emplace_back(header)};
+            index.phashBlock = &hashes.back();
+            index.pprev = i > 0 ? &entries[i - 1] : nullptr;
+            index.nHeight = i;
+        }
+    }
+};
+} // namespace
+
+/* YespowerSugar */
+// Load time of a block tree where every entry has its PoW hash stored next to it.
+static void BlockIndexLoad(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN)};
+    const auto& params{Params()};
+    BlockIndexChain chain{params.GenesisBlock()};
+
+    CBlockTreeDB block_tree{DBParams{.path = "", .cache_bytes = 1 << 20, .memory_only = true}};
+    std::vector<const CBlockIndex*> dirty;
+    std::vector<std::pair<uint256, uint256>> pow_hashes;
+    for (const CBlockIndex& index : chain.entries) {
+        dirty.push_back(&index);
+        // Any hash meets the target as far as the load-time check is concerned.
+        pow_hashes.emplace_back(index.GetBlockHash(), uint256::ZERO);
+    }
+    assert(block_tree.WriteBatchSync({}, 0, dirty, pow_hashes));
+
+    bench.batch(NUM_BLOCK_INDEX_ENTRIES).unit("entry").run([&] {
+        BlockMap block_index;
+        std::vector<CBlockIndex*> missing_pow_hash;
+        const auto insert{[&](const uint256& hash) -> CBlockIndex* {
+            if (hash.IsNull()) return nullptr;
+            const auto [it, inserted]{block_index.try_emplace(hash)};
+            if (inserted) it->second.phashBlock = &it->first;
+            return &it->second;
+        }};
+        LOCK(cs_main);
+        assert(block_tree.LoadBlockIndexGuts(params.GetConsensus(), insert, missing_pow_hash));
+        assert(block_index.size() == NUM_BLOCK_INDEX_ENTRIES && missing_pow_hash.empty());
+    });
+}
+
+// Building the in-memory block index; dominated by allocating CBlockIndex
+// entries, so it tracks sizeof(CBlockIndex). The memory the block index takes
+// per entry is printed and kept as the "bytes/entry" context of the result.
+static void BlockIndexMemory(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN)};
+    BlockIndexChain chain{Params().GenesisBlock()};
+    const auto build{[&] {
+        BlockMap block_index;
+        block_index.reserve(NUM_BLOCK_INDEX_ENTRIES);
+        for (const CBlockIndex& index : chain.entries) {
+            block_index.try_emplace(index.GetBlockHash(), index.GetBlockHeader());
+        }
+        return block_index;
+    }};
+
+    const double bytes_per_entry{double(memusage::DynamicUsage(build())) / NUM_BLOCK_INDEX_ENTRIES};
+    bench.context("bytes/entry", strprintf("%.1f", bytes_per_entry));
+    if (bench.output()) *bench.output() << strprintf("%s: %.1f bytes/entry\n", bench.name(), bytes_per_entry);
+    bench.batch(NUM_BLOCK_INDEX_ENTRIES).unit("entry").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(build());
+    });
+}
+
+// Lookups in a full PoW hash cache, as done for every header and block.
+static void PoWHashCacheLookup(benchmark::Bench& bench)
+{
+    PoWHashCache cache;
+    std::vector<uint256> hashes;
+    for (size_t i = 0; i < cache.MaxSize(); ++i) {
+        hashes.push_back(ArithToUint256(arith_uint256{i}));
+        cache.Insert(hashes.back(), hashes.back());
+    }
+
+    size_t i{0};
+    bench.run([&] {
+        auto pow_hash{cache.Get(hashes[i++ % hashes.size()])};
+        ankerl::nanobench::doNotOptimizeAway(pow_hash);
+    });
+}
+
+BENCHMARK(BlockIndexLoad, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockIndexMemory, benchmark::PriorityLevel::HIGH);
+BENCHMARK(PoWHashCacheLookup, benchmark::PriorityLevel::HIGH);
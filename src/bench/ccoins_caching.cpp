@@ -5,9 +5,12 @@
 #include <bench/bench.h>
 #include <coins.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
+#include <tinyformat.h>
 
+#include <cassert>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -50,4 +53,39 @@ static void CCoinsCaching(benchmark::Bench& bench)
     ECC_Stop();
 }
 
+/* YespowerSugar */
+/** Coins held by the cache of CCoinsCachingLookup. */
+static constexpr uint32_t LOOKUP_BENCH_COINS{100000};
+
+/* YespowerSugar */
+// Looking up coins in a cache that holds them, in random order as for the
+// inputs of a block. The memory the cache takes per coin is printed and kept
+// as the "bytes/coin" context of the result; the scripts are small enough to
+// need no memory of their own, so that is all the cache's overhead.
+static void CCoinsCachingLookup(benchmark::Bench& bench)
+{
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(LOOKUP_BENCH_COINS);
+    for (uint32_t i = 0; i < LOOKUP_BENCH_COINS; ++i) {
+        outpoints.emplace_back(rng.rand256(), i % 4);
+        CTxOut out{COIN, CScript() << OP_0 << std::vector<unsigned char>(20, i % 256)};
+        coins.AddCoin(outpoints.back(), Coin{std::move(out), /*nHeightIn=*/1, /*fCoinBaseIn=*/false}, /*possible_overwrite=*/false);
+    }
+    Shuffle(outpoints.begin(), outpoints.end(), rng);
+
+    const double bytes_per_coin{double(coins.DynamicMemoryUsage()) / coins.GetCacheSize()};
+    bench.context("bytes/coin", strprintf("%.1f", bytes_per_coin));
+    if (bench.output()) *bench.output() << strprintf("%s: %.1f bytes/coin\n", bench.name(), bytes_per_coin);
+    bench.batch(outpoints.size()).unit("lookup").run([&] {
+        for (const COutPoint& outpoint : outpoints) {
+            bool found{!coins.AccessCoin(outpoint).IsSpent()};
+            assert(found);
+        }
+    });
+}
+
 BENCHMARK(CCoinsCaching, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCoinsCachingLookup, benchmark::PriorityLevel::HIGH);
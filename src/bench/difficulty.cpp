@@ -0,0 +1,61 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <pow.h>
+#include <random.h>
+#include <util/system.h>
+
+#include <vector>
+
+/* SugarShield */
+// Next work required for every header of a 100k header chain, as checked
+// during headers sync.
+static constexpr size_t NUM_HEADERS{100'000};
+
+static std::vector<CBlockIndex> MakeChain(const Consensus::Params& params)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const arith_uint256 pow_limit{UintToArith256(params.powLimit)};
+    std::vector<CBlockIndex> blocks(NUM_HEADERS);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        CBlockIndex* prev{i ? &blocks[i - 1] : nullptr};
+        blocks[i].pprev = prev;
+        blocks[i].nHeight = i;
+        blocks[i].nTime = prev ? prev->nTime + rng.randrange(2 * params.nPowTargetSpacing) : 1269211443;
+        blocks[i].nBits = arith_uint256{pow_limit >> (8 + rng.randrange(4))}.GetCompact();
+    }
+    return blocks;
+}
+
+// GetNextWorkRequired(), walking the whole averaging window for every header.
+static void DifficultyWalk(benchmark::Bench& bench)
+{
+    const auto chain_params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const std::vector<CBlockIndex> blocks{MakeChain(chain_params->GetConsensus())};
+    bench.epochs(1).epochIterations(1).batch(NUM_HEADERS).unit("header").run([&] {
+        for (const CBlockIndex& block : blocks) {
+            ankerl::nanobench::doNotOptimizeAway(GetNextWorkRequired(&block, nullptr, chain_params->GetConsensus()));
+        }
+    });
+}
+
+// DifficultyWindow, sliding the averaging window by one block per header.
+static void DifficultyWindowSlide(benchmark::Bench& bench)
+{
+    const auto chain_params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const std::vector<CBlockIndex> blocks{MakeChain(chain_params->GetConsensus())};
+    bench.batch(NUM_HEADERS).unit("header").run([&] {
+        DifficultyWindow window;
+        for (const CBlockIndex& block : blocks) {
+            ankerl::nanobench::doNotOptimizeAway(window.GetNextWorkRequired(&block, chain_params->GetConsensus()));
+        }
+    });
+}
+
+BENCHMARK(DifficultyWalk, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DifficultyWindowSlide, benchmark::PriorityLevel::HIGH);
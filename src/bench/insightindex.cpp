@@ -0,0 +1,93 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbwrapper.h>
+#include <random.h>
+#include <spentindex.h>
+#include <util/fs.h>
+
+#include <vector>
+
+namespace {
+/** Address index entries of a regtest-like chain: every block pays a coinbase
+ *  to one of a few P2PKH addresses and has a handful of transactions moving
+ *  coins between them. */
+std::vector<std::pair<CAddressIndexKey, CAmount>> MakeAddressIndexEntries(int blocks)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<uint256> addresses;
+    for (int i = 0; i < 16; ++i) {
+        const std::vector<unsigned char> hash{rng.randbytes(20)};
+        addresses.emplace_back(hash.data(), hash.size());
+    }
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+    for (int height = 1; height <= blocks; ++height) {
+        for (unsigned int tx = 0; tx < 8; ++tx) {
+            const uint256 txid{rng.rand256()};
+            const uint256& address{addresses[rng.randrange(addresses.size())]};
+            entries.emplace_back(CAddressIndexKey(1, address, height, tx, txid, 0, false), 50 * COIN);
+            if (tx > 0) {
+                const uint256& from{addresses[rng.randrange(addresses.size())]};
+                entries.emplace_back(CAddressIndexKey(1, from, height, tx, txid, 0, true), -50 * COIN);
+            }
+        }
+    }
+    return entries;
+}
+
+/** Index keys in the version 1 encoding, which is how the insight index
+ *  stored them before the compact format. */
+template <typename T>
+struct LegacyKey {
+    T obj;
+    SERIALIZE_METHODS(LegacyKey, o) { READWRITE(Using<LegacyIndexFormatter>(o.obj)); }
+};
+
+template <typename T>
+struct CompactKey {
+    T obj;
+    SERIALIZE_METHODS(CompactKey, o) { READWRITE(o.obj); }
+};
+
+template <template <typename> class Encoding>
+void WriteAndScanAddressIndex(benchmark::Bench& bench)
+{
+    const auto entries{MakeAddressIndexEntries(1000)};
+    const CAddressIndexIteratorKey address{entries[0].first.type, entries[0].first.hashBytes};
+
+    bench.batch(entries.size()).unit("entry").run([&] {
+        CDBWrapper db({.path = "", .cache_bytes = 1 << 20, .memory_only = true});
+        CDBBatch batch(db);
+        for (const auto& [key, value] : entries) {
+            batch.Write(std::make_pair(uint8_t{'a'}, Encoding<CAddressIndexKey>{key}), value);
+        }
+        db.WriteBatch(batch);
+
+        // The entries of one address are adjacent in either encoding.
+        std::unique_ptr<CDBIterator> it{db.NewIterator()};
+        size_t found{0};
+        for (it->Seek(std::make_pair(uint8_t{'a'}, Encoding<CAddressIndexIteratorKey>{address})); it->Valid(); it->Next()) {
+            std::pair<uint8_t, Encoding<CAddressIndexKey>> key;
+            if (!it->GetKey(key) || key.second.obj.hashBytes != address.hashBytes) break;
+            ++found;
+        }
+        assert(found > 0);
+    });
+}
+} // namespace
+
+static void InsightIndexKeysLegacy(benchmark::Bench& bench)
+{
+    WriteAndScanAddressIndex<LegacyKey>(bench);
+}
+
+static void InsightIndexKeysCompact(benchmark::Bench& bench)
+{
+    WriteAndScanAddressIndex<CompactKey>(bench);
+}
+
+BENCHMARK(InsightIndexKeysLegacy, benchmark::PriorityLevel::HIGH);
+BENCHMARK(InsightIndexKeysCompact, benchmark::PriorityLevel::HIGH);
@@ -5,8 +5,12 @@
 #include <bench/bench.h>
 #include <bench/data.h>
 #include <chainparams.h>
+#include <consensus/merkle.h>
+#include <pow.h>
+#include <test/util/script.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
+#include <versionbits.h>
 
 /**
  * The LoadExternalBlockFile() function is used during -reindex and -loadblock.
@@ -30,10 +34,10 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     DataStream ss{};
     auto params{testing_setup->m_node.chainman->GetParams()};
     ss << params.MessageStart();
-    ss << static_cast<uint32_t>(benchmark::data::block413567.size());
-    // We can't use the streaming serialization (ss << benchmark::data::block413567)
+    ss << static_cast<uint32_t>(benchmark::data::block6513497.size());
+    // We can't use the streaming serialization (ss << benchmark::data::block6513497)
     // because that first writes a compact size.
-    ss.write(MakeByteSpan(benchmark::data::block413567));
+    ss.write(MakeByteSpan(benchmark::data::block6513497));
 
     // Create the test file.
     {
@@ -60,4 +64,75 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     fs::remove(blkfile);
 }
 
+/* YespowerSugar */
+/** Blocks per fork in LoadExternalBlockFileAccept, each of which costs a
+ *  couple of yespower hashes to mine. */
+static constexpr int ACCEPT_BENCH_BLOCKS{32};
+static constexpr int ACCEPT_BENCH_FORKS{3};
+
+/* YespowerSugar */
+/**
+ * Unlike the benchmark above, the blocks of this file are accepted: it holds
+ * a chain of blocks on top of the regtest genesis block, so this measures
+ * decoding them, computing their PoW hashes on the PoW worker pool and
+ * storing them. Every run loads a different fork off genesis, so that its
+ * blocks aren't known yet.
+ */
+static void LoadExternalBlockFileAccept(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::REGTEST)};
+    const CChainParams& params{testing_setup->m_node.chainman->GetParams()};
+
+    std::vector<fs::path> blkfiles;
+    for (int fork = 0; fork < ACCEPT_BENCH_FORKS; ++fork) {
+        DataStream ss{};
+        CBlock prev{params.GenesisBlock()};
+        for (int height = 1; height <= ACCEPT_BENCH_BLOCKS; ++height) {
+            CMutableTransaction coinbase_tx;
+            coinbase_tx.vin.resize(1);
+            coinbase_tx.vin[0].prevout.SetNull();
+            coinbase_tx.vin[0].scriptSig = CScript() << height << fork;
+            coinbase_tx.vout.resize(1);
+            coinbase_tx.vout[0].scriptPubKey = P2WSH_OP_TRUE;
+            coinbase_tx.vout[0].nValue = GetBlockSubsidy(height, params.GetConsensus());
+
+            CBlock block;
+            block.vtx = {MakeTransactionRef(std::move(coinbase_tx))};
+            block.nVersion = VERSIONBITS_LAST_OLD_BLOCK_VERSION;
+            block.hashPrevBlock = prev.GetHash();
+            block.hashMerkleRoot = BlockMerkleRoot(block);
+            block.nTime = prev.nTime + 1;
+            block.nBits = params.GenesisBlock().nBits;
+            while (!CheckProofOfWork(block.GetPoWHash(), block.nBits, params.GetConsensus())) {
+                ++block.nNonce;
+            }
+
+            CDataStream block_data{SER_DISK, CLIENT_VERSION};
+            block_data << block;
+            ss << params.MessageStart() << static_cast<uint32_t>(block_data.size());
+            ss.write(MakeByteSpan(block_data));
+            prev = block;
+        }
+
+        blkfiles.push_back(testing_setup->m_path_root / fs::u8path(strprintf("blk%d.dat", fork)));
+        FILE* file{fsbridge::fopen(blkfiles.back(), "wb+")};
+        if (fwrite(ss.data(), 1, ss.size(), file) != ss.size()) {
+            throw std::runtime_error("write to test file failed\n");
+        }
+        fclose(file);
+    }
+
+    Chainstate& chainstate{testing_setup->m_node.chainman->ActiveChainstate()};
+    size_t run{0};
+    bench.epochs(ACCEPT_BENCH_FORKS).epochIterations(1).batch(ACCEPT_BENCH_BLOCKS).unit("block").run([&] {
+        // Once every fork was loaded, the blocks are only found to be known.
+        FILE* file{fsbridge::fopen(blkfiles.at(run++ % blkfiles.size()), "rb")};
+        chainstate.LoadExternalBlockFile(file);
+    });
+    for (const fs::path& blkfile : blkfiles) {
+        fs::remove(blkfile);
+    }
+}
+
 BENCHMARK(LoadExternalBlockFile, benchmark::PriorityLevel::HIGH);
+BENCHMARK(LoadExternalBlockFileAccept, benchmark::PriorityLevel::HIGH);
@@ -3,8 +3,10 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <crypto/common.h>
 #include <kernel/mempool_entry.h>
 #include <policy/policy.h>
+#include <script/standard.h>
 #include <test/util/setup_common.h>
 #include <txmempool.h>
 #include <validation.h>
@@ -28,7 +30,17 @@ struct Available {
     Available(CTransactionRef& ref, size_t tx_count) : ref(ref), tx_count(tx_count){}
 };
 
-static std::vector<CTransactionRef> CreateOrderedCoins(FastRandomContext& det_rand, int childTxs, int min_ancestors)
+/** Output script of the n-th output created: a bare script, or one of a few
+ *  P2PKH addresses when the address index is exercised. */
+static CScript OutputScript(size_t tx_counter, bool p2pkh)
+{
+    if (!p2pkh) return CScript() << CScriptNum(tx_counter) << OP_EQUAL;
+    uint160 hash;
+    WriteLE64(hash.begin(), tx_counter % 64);
+    return GetScriptForDestination(PKHash{hash});
+}
+
+static std::vector<CTransactionRef> CreateOrderedCoins(FastRandomContext& det_rand, int childTxs, int min_ancestors, bool p2pkh = false)
 {
     std::vector<Available> available_coins;
     std::vector<CTransactionRef> ordered_coins;
@@ -41,7 +53,7 @@ static std::vector<CTransactionRef> CreateOrderedCoins(FastRandomContext& det_ra
         tx.vin[0].scriptWitness.stack.push_back(CScriptNum(x).getvch());
         tx.vout.resize(det_rand.randrange(10)+2);
         for (auto& out : tx.vout) {
-            out.scriptPubKey = CScript() << CScriptNum(tx_counter) << OP_EQUAL;
+            out.scriptPubKey = OutputScript(tx_counter, p2pkh);
             out.nValue = 10 * COIN;
         }
         ordered_coins.emplace_back(MakeTransactionRef(tx));
@@ -70,7 +82,7 @@ static std::vector<CTransactionRef> CreateOrderedCoins(FastRandomContext& det_ra
             }
             tx.vout.resize(det_rand.randrange(10)+2);
             for (auto& out : tx.vout) {
-                out.scriptPubKey = CScript() << CScriptNum(tx_counter) << OP_EQUAL;
+                out.scriptPubKey = OutputScript(tx_counter, p2pkh);
                 out.nValue = 10 * COIN;
             }
         }
@@ -100,6 +112,34 @@ static void ComplexMemPool(benchmark::Bench& bench)
     });
 }
 
+/** Maintaining the mempool address and spent indexes (-addressindex,
+ *  -spentindex) for a flood of transactions that is then evicted. */
+static void MempoolAddressIndex(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins = CreateOrderedCoins(det_rand, /*childTxs=*/800, /*min_ancestors=*/1, /*p2pkh=*/true);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    CCoinsView base;
+    CCoinsViewCache view{&base};
+    std::vector<CTxMemPoolEntry> entries;
+    for (const auto& tx : ordered_coins) {
+        AddCoins(view, *tx, /*nHeight=*/1);
+        entries.emplace_back(tx, 1000, /*time=*/0, /*entry_height=*/1, /*spends_coinbase=*/false, /*sigops_cost=*/4, LockPoints{});
+    }
+    LOCK(pool.cs);
+    bench.batch(entries.size()).unit("tx").run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& entry : entries) {
+            pool.addAddressIndex(entry, view);
+            pool.addSpentIndex(entry, view);
+        }
+        for (const auto& entry : entries) {
+            pool.removeAddressIndex(entry.GetTx().GetHash());
+            pool.removeSpentIndex(entry.GetTx());
+        }
+    });
+}
+
 static void MempoolCheck(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -116,4 +156,5 @@ static void MempoolCheck(benchmark::Bench& bench)
 }
 
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAddressIndex, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,64 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <cassert>
+
+/* YespowerSugar */
+// Reading a block of the block index back from disk, as done for serving
+// peers, getblock, rescans and index sync. The trusted read only matches the
+// block against its index entry; the paranoid one (-checkblockreadpow)
+// recomputes its yespower hash as well.
+static void ReadBlockFromDiskBench(benchmark::Bench& bench, bool check_pow)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::MAIN)};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+
+    CBlock block;
+    CDataStream stream(benchmark::data::block6513497, SER_NETWORK, PROTOCOL_VERSION);
+    stream >> block;
+    const uint256 hash{block.GetHash()};
+
+    CBlockIndex index{block};
+    index.phashBlock = &hash;
+    {
+        LOCK(cs_main);
+        const FlatFilePos pos{chainman.m_blockman.SaveBlockToDisk(block, /*nHeight=*/1, chainman.ActiveChain(), chainman.GetParams(), /*dbp=*/nullptr)};
+        assert(!pos.IsNull());
+        index.nFile = pos.nFile;
+        index.nDataPos = pos.nPos;
+        index.nStatus |= BLOCK_HAVE_DATA;
+    }
+
+    node::g_check_block_read_pow = check_pow;
+    bench.unit("block").run([&] {
+        CBlock read;
+        bool ok{node::ReadBlockFromDisk(read, &index, chainman.GetConsensus())};
+        assert(ok);
+    });
+    node::g_check_block_read_pow = node::DEFAULT_CHECK_BLOCK_READ_POW;
+}
+
+static void ReadBlockFromDiskTrusted(benchmark::Bench& bench)
+{
+    ReadBlockFromDiskBench(bench, /*check_pow=*/false);
+}
+
+static void ReadBlockFromDiskParanoid(benchmark::Bench& bench)
+{
+    ReadBlockFromDiskBench(bench, /*check_pow=*/true);
+}
+
+BENCHMARK(ReadBlockFromDiskTrusted, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ReadBlockFromDiskParanoid, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,161 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include <chainparams.h>
+#include <crypto/yespower.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <vector>
+
+/* YespowerSugar */
+// Benchmarks for the yespower proof-of-work check, which dominates header and
+// block verification. All of them hash the header of block 6513497 so that
+// results stay comparable between releases.
+
+/** Number of headers in a full headers message (MAX_HEADERS_RESULTS) */
+static constexpr size_t HEADER_BATCH_SIZE{2000};
+
+static CBlockHeader TestHeader()
+{
+    CDataStream stream(benchmark::data::block6513497, SER_NETWORK, PROTOCOL_VERSION);
+    CBlock block;
+    stream >> block;
+    return block.GetBlockHeader();
+}
+
+// Raw yespower over one serialized header, using the shared context pool.
+static void YespowerPoWHash(benchmark::Bench& bench)
+{
+    const CBlockHeader header{TestHeader()};
+    bench.unit("header").run([&] {
+        uint256 pow_hash{header.GetPoWHash()};
+        ankerl::nanobench::doNotOptimizeAway(pow_hash);
+    });
+}
+
+// The same hash through yespower_tls() and a heap stream, as GetPoWHash() used
+// to do, to compare against the pooled huge-page contexts.
+static void YespowerPoWHashTLS(benchmark::Bench& bench)
+{
+    static const yespower_params_t params = {
+        .version = YESPOWER_1_0,
+        .N = 2048,
+        .r = 32,
+        .pers = (const uint8_t*)"Satoshi Nakamoto 31/Oct/2008 Proof-of-work is essentially one-CPU-one-vote",
+        .perslen = 74,
+    };
+    const CBlockHeader header{TestHeader()};
+    bench.unit("header").run([&] {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << header;
+        uint256 pow_hash;
+        YespowerTLS(UCharCast(ss.data()), ss.size(), &params, (yespower_binary_t*)&pow_hash);
+        ankerl::nanobench::doNotOptimizeAway(pow_hash);
+    });
+}
+
+// GetPoWHash_cached() on a header whose PoW hash is already known.
+static void YespowerPoWHashCached(benchmark::Bench& bench)
+{
+    const CBlockHeader header{TestHeader()};
+    header.GetPoWHash_cached();
+    bench.unit("header").run([&] {
+        uint256 pow_hash{header.GetPoWHash_cached()};
+        ankerl::nanobench::doNotOptimizeAway(pow_hash);
+    });
+}
+
+// GetPoWHash_cached() on a fresh header, which computes and fills the cache.
+static void YespowerPoWHashUncached(benchmark::Bench& bench)
+{
+    const CBlockHeader uncached{TestHeader()};
+    bench.unit("header").run([&] {
+        const CBlockHeader header{uncached};
+        uint256 pow_hash{header.GetPoWHash_cached()};
+        ankerl::nanobench::doNotOptimizeAway(pow_hash);
+    });
+}
+
+// The proof of work check CheckBlockHeader does for a single announced
+// header: yespower through the header's cache plus the target comparison.
+static void YespowerCheckProofOfWork(benchmark::Bench& bench)
+{
+    const auto chain_params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const CBlockHeader uncached{TestHeader()};
+    bench.unit("header").run([&] {
+        const CBlockHeader header{uncached};
+        bool valid{CheckProofOfWork(header.GetPoWHash_cached(), header.nBits, chain_params->GetConsensus())};
+        assert(valid);
+    });
+}
+
+static void CheckHeaderBatch(benchmark::Bench& bench)
+{
+    const auto chain_params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const CBlockHeader uncached{TestHeader()};
+    bench.epochs(3).epochIterations(1).batch(HEADER_BATCH_SIZE).unit("header").run([&] {
+        const std::vector<CBlockHeader> headers(HEADER_BATCH_SIZE, uncached);
+        bool valid{HasValidProofOfWork(headers, chain_params->GetConsensus())};
+        assert(valid);
+    });
+}
+
+// A full headers message checked on the calling thread only.
+static void YespowerHeaderBatch(benchmark::Bench& bench)
+{
+    CheckHeaderBatch(bench);
+}
+
+// A full headers message checked on the PoW worker pool by `threads` threads,
+// the caller included. Thread counts beyond the cores of the machine are
+// skipped, as they would only measure contention.
+static void CheckHeaderBatchParallel(benchmark::Bench& bench, int threads)
+{
+    threads = std::min(threads, MAX_POWCHECK_THREADS + 1);
+    if (threads <= 1 || threads > GetNumCores()) return;
+
+    StartPoWCheckWorkerThreads(threads - 1);
+    CheckHeaderBatch(bench);
+    StopPoWCheckWorkerThreads();
+}
+
+static void YespowerHeaderBatch2Threads(benchmark::Bench& bench)
+{
+    CheckHeaderBatchParallel(bench, 2);
+}
+
+static void YespowerHeaderBatch4Threads(benchmark::Bench& bench)
+{
+    CheckHeaderBatchParallel(bench, 4);
+}
+
+static void YespowerHeaderBatch8Threads(benchmark::Bench& bench)
+{
+    CheckHeaderBatchParallel(bench, 8);
+}
+
+// One thread per core.
+static void YespowerHeaderBatchParallel(benchmark::Bench& bench)
+{
+    CheckHeaderBatchParallel(bench, GetNumCores());
+}
+
+BENCHMARK(YespowerPoWHash, benchmark::PriorityLevel::HIGH);
+BENCHMARK(YespowerPoWHashTLS, benchmark::PriorityLevel::HIGH);
+BENCHMARK(YespowerPoWHashCached, benchmark::PriorityLevel::HIGH);
+BENCHMARK(YespowerPoWHashUncached, benchmark::PriorityLevel::HIGH);
+BENCHMARK(YespowerCheckProofOfWork, benchmark::PriorityLevel::HIGH);
+BENCHMARK(YespowerHeaderBatch, benchmark::PriorityLevel::LOW);
+BENCHMARK(YespowerHeaderBatch2Threads, benchmark::PriorityLevel::LOW);
+BENCHMARK(YespowerHeaderBatch4Threads, benchmark::PriorityLevel::LOW);
+BENCHMARK(YespowerHeaderBatch8Threads, benchmark::PriorityLevel::LOW);
+BENCHMARK(YespowerHeaderBatchParallel, benchmark::PriorityLevel::LOW);
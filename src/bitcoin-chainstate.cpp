@@ -94,11 +94,6 @@ int main(int argc, char* argv[])
     cache_sizes.coins = (450 << 20) - (2 << 20) - (2 << 22);
     node::ChainstateLoadOptions options;
     options.check_interrupt = [] { return false; };
-
-    options.addressindex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-    options.spentindex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-    options.timestampindex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-
     auto [status, error] = node::LoadChainstate(chainman, cache_sizes, options);
     if (status != node::ChainstateLoadStatus::SUCCESS) {
         std::cerr << "Failed to load Chain state from your datadir." << std::endl;
@@ -256,6 +251,7 @@ epilogue:
     scheduler.stop();
     if (chainman.m_load_block.joinable()) chainman.m_load_block.join();
     StopScriptCheckWorkerThreads();
+    StopPoWCheckWorkerThreads();
 
     GetMainSignals().FlushBackgroundCallbacks();
     {
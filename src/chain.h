@@ -207,24 +207,12 @@ public:
     uint32_t nBits{0};
     uint32_t nNonce{0};
 
-    /* YespowerSugar */
-    //! (currently memory only, but don't have to be)
-    bool cache_init{false};
-    uint256 cache_block_hash{};
-    uint256 cache_PoW_hash{};
-
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     int32_t nSequenceId{0};
 
     //! (memory only) Maximum nTime in the chain up to and including this block.
     unsigned int nTimeMax{0};
 
-    /* YespowerSugar */
-    void SetNullCacheInit()
-    {
-        cache_init = false;
-    }
-
     explicit CBlockIndex(const CBlockHeader& block)
         : nVersion{block.nVersion},
           hashMerkleRoot{block.hashMerkleRoot},
@@ -232,11 +220,6 @@ public:
           nBits{block.nBits},
           nNonce{block.nNonce}
     {
-        /* YespowerSugar */
-        SetNullCacheInit();
-        cache_init = block.cache_init;
-        cache_block_hash = block.cache_block_hash;
-        cache_PoW_hash = block.cache_PoW_hash;
     }
 
     FlatFilePos GetBlockPos() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
@@ -271,12 +254,6 @@ public:
         block.nTime = nTime;
         block.nBits = nBits;
         block.nNonce = nNonce;
-        
-        /* YespowerSugar */
-        block.cache_init = cache_init;
-        block.cache_block_hash = cache_block_hash;
-        block.cache_PoW_hash = cache_PoW_hash;
-
         return block;
     }
 
@@ -287,6 +264,8 @@ public:
     }
 
     /* YespowerSugar */
+    //! The PoW hash is not kept on the index entry; known values live in
+    //! BlockManager's PoW hash cache and the block tree db.
     uint256 GetBlockPoWHash() const
     {
         return GetBlockHeader().GetPoWHash();
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <string>
 #include <vector>
 
 template <typename T>
@@ -136,8 +137,10 @@ public:
     {
     }
 
-    //! Create a pool of new worker threads.
-    void StartWorkerThreads(const int threads_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    //! Create a pool of new worker threads, named <thread_name>.<N> and
+    //! running under the given syscall sandbox policy.
+    void StartWorkerThreads(const int threads_num, const std::string& thread_name = "scriptch",
+                            SyscallSandboxPolicy policy = SyscallSandboxPolicy::VALIDATION_SCRIPT_CHECK) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         {
             LOCK(m_mutex);
@@ -147,9 +150,9 @@ public:
         }
         assert(m_worker_threads.empty());
         for (int n = 0; n < threads_num; ++n) {
-            m_worker_threads.emplace_back([this, n]() {
-                util::ThreadRename(strprintf("scriptch.%i", n));
-                SetSyscallSandboxPolicy(SyscallSandboxPolicy::VALIDATION_SCRIPT_CHECK);
+            m_worker_threads.emplace_back([this, n, thread_name, policy]() {
+                util::ThreadRename(strprintf("%s.%i", thread_name, n));
+                SetSyscallSandboxPolicy(policy);
                 Loop(false /* worker thread */);
             });
         }
@@ -257,6 +257,10 @@ bool CCoinsViewCache::Flush() {
         /* BatchWrite must erase all cacheCoins elements when erase=true. */
         throw std::logic_error("Not all cached coins were erased");
     }
+    /* YespowerSugar */
+    // The emptied map would otherwise keep the slabs and table of its peak
+    // size, and the cache would still count as full.
+    if (fOk) ReallocateCache();
     cachedCoinsUsage = 0;
     return fOk;
 }
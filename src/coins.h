@@ -11,6 +11,7 @@
 #include <memusage.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
+#include <slabhashmap.h>
 #include <uint256.h>
 #include <util/hasher.h>
 
@@ -18,7 +19,6 @@
 #include <stdint.h>
 
 #include <functional>
-#include <unordered_map>
 
 /**
  * A UTXO entry.
@@ -131,7 +131,9 @@ struct CCoinsCacheEntry
     CCoinsCacheEntry(Coin&& coin_, unsigned char flag) : coin(std::move(coin_)), flags(flag) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/* YespowerSugar */
+/** The coins of a cache, stored in slabs rather than one allocation per coin. */
+typedef SlabHashMap<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -317,10 +319,8 @@ public:
     bool HaveInputs(const CTransaction& tx) const;
 
     //! Force a reallocation of the cache map. This is required when downsizing
-    //! the cache because the map's allocator may be hanging onto a lot of
-    //! memory despite having called .clear().
-    //!
-    //! See: https://stackoverflow.com/questions/42114044/how-to-release-unordered-map-memory
+    //! the cache because the map keeps its table and slabs despite having
+    //! called .clear().
     void ReallocateCache();
 
     //! Run an internal sanity check on the cache data structure. */
@@ -0,0 +1,325 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
+#include <crypto/yespower.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <compat/cpuid.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+/* YespowerSugar */
+// Variants of yespower-opt.c built with extra instruction sets, see
+// crypto/yespower_avx.c and crypto/yespower_xop.c.
+extern "C" {
+int yespower_avx(yespower_local_t* local, const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+int yespower_tls_avx(const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+int yespower_xop(yespower_local_t* local, const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+int yespower_tls_xop(const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+}
+
+namespace {
+typedef int (*YespowerFn)(yespower_local_t* local, const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+typedef int (*YespowerTLSFn)(const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+
+// Currently selected implementation, the one built with the default compiler flags until autodetected.
+YespowerFn YespowerImpl = yespower;
+YespowerTLSFn YespowerTLSImpl = yespower_tls;
+
+/** Check the selected implementation against a test vector from yespower's TESTS-OK. */
+bool SelfTest()
+{
+    static const yespower_params_t params = {
+        .version = YESPOWER_1_0,
+        .N = 2048,
+        .r = 32,
+        .pers = nullptr,
+        .perslen = 0,
+    };
+    static const uint8_t expected[32] = {
+        0xd5, 0xef, 0xb8, 0x13, 0xcd, 0x26, 0x3e, 0x9b, 0x34, 0x54, 0x01, 0x30, 0x23, 0x3c, 0xbb, 0xc6,
+        0xa9, 0x21, 0xfb, 0xff, 0x34, 0x31, 0xe5, 0xec, 0x1a, 0x1a, 0xbd, 0xe2, 0xae, 0xa6, 0xff, 0x4d,
+    };
+    uint8_t src[80];
+    for (size_t i = 0; i < sizeof(src); ++i) src[i] = i * 3;
+
+    // Use a local allocation rather than keeping thread-local memory around.
+    yespower_local_t local;
+    yespower_init_local(&local);
+    yespower_binary_t result;
+    const bool ok{YespowerImpl(&local, src, sizeof(src), &params, &result) == 0 &&
+                  memcmp(result.uc, expected, sizeof(expected)) == 0};
+    yespower_free_local(&local);
+    return ok;
+}
+
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+} // namespace
+
+std::string YespowerAutoDetect()
+{
+#if defined(__SSE2__)
+    std::string ret = "sse2";
+#else
+    std::string ret = "generic";
+#endif
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+    bool have_xsave = false;
+    bool have_avx = false;
+    [[maybe_unused]] bool have_xop = false;
+    [[maybe_unused]] bool enabled_avx = false;
+
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    have_xsave = (ecx >> 27) & 1;
+    have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx) {
+        enabled_avx = AVXEnabled();
+    }
+    GetCPUID(0x80000000, 0, eax, ebx, ecx, edx);
+    if (eax >= 0x80000001) {
+        GetCPUID(0x80000001, 0, eax, ebx, ecx, edx);
+        have_xop = (ecx >> 11) & 1;
+    }
+
+    // Per the yespower documentation, XOP is almost always the fastest where
+    // supported. AVX-512 and AVX2 are not used by yespower-opt.c at all.
+#if defined(ENABLE_AVX) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_avx && enabled_avx) {
+        YespowerImpl = yespower_avx;
+        YespowerTLSImpl = yespower_tls_avx;
+        ret = "avx";
+    }
+#endif
+#if defined(ENABLE_XOP) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_xop && have_avx && enabled_avx) {
+        YespowerImpl = yespower_xop;
+        YespowerTLSImpl = yespower_tls_xop;
+        ret = "xop";
+    }
+#endif
+#endif // defined(USE_ASM) && defined(HAVE_GETCPUID)
+
+    assert(SelfTest());
+    return ret;
+}
+
+int YespowerTLS(const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst)
+{
+    return YespowerTLSImpl(src, srclen, params, dst);
+}
+
+int Yespower(yespower_local_t* local, const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst)
+{
+    return YespowerImpl(local, src, srclen, params, dst);
+}
+
+size_t YespowerScratchSize(const yespower_params_t& params)
+{
+    // Mirrors the allocation in yespower() (yespower-opt.c): B, V, XY and the
+    // pwxform S-boxes (Swidth 8 with 2 S-boxes for 0.5, Swidth 11 with 3 for 1.0).
+    const size_t B_size{size_t{128} * params.r};
+    const size_t V_size{B_size * params.N};
+    if (params.version == YESPOWER_0_5) {
+        return B_size + V_size + B_size * 2 + 2 * ((1 << 8) * 2 * 8);
+    }
+    return B_size + V_size + B_size + 64 + 3 * ((1 << 11) * 2 * 8);
+}
+
+namespace {
+#if defined(MAP_ANONYMOUS)
+constexpr size_t HUGE_PAGE_SIZE{2 * 1024 * 1024};
+#endif
+
+/** Memory a context for `need` bytes of scratch takes up. */
+size_t MappedSize(size_t need)
+{
+#if defined(MAP_ANONYMOUS)
+    // munmap() of a MAP_HUGETLB mapping fails unless the size is a multiple of the huge page size.
+    return (need + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#else
+    return need;
+#endif
+}
+} // namespace
+
+YespowerContextPool::YespowerContextPool(size_t max_bytes) : m_max_bytes(max_bytes) {}
+
+YespowerContextPool::~YespowerContextPool()
+{
+    for (Context* ctx : m_idle) Free(ctx);
+}
+
+YespowerContextPool::Context* YespowerContextPool::Allocate(size_t need)
+{
+    Context* ctx = new Context{};
+    yespower_init_local(&ctx->local);
+    ctx->size = need;
+#if defined(MAP_ANONYMOUS)
+    const size_t size{MappedSize(need)};
+    void* base{MAP_FAILED};
+#if defined(MAP_HUGETLB)
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    ctx->huge_pages = base != MAP_FAILED;
+#endif
+    if (base == MAP_FAILED) {
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#if defined(MADV_HUGEPAGE)
+        if (base != MAP_FAILED) madvise(base, size, MADV_HUGEPAGE);
+#endif
+    }
+    if (base != MAP_FAILED) {
+        // yespower() reuses the region as long as aligned_size covers what it needs.
+        ctx->local.base = ctx->local.aligned = base;
+        ctx->local.base_size = size;
+        ctx->local.aligned_size = need;
+        ctx->size = size;
+        ctx->pool_owned = true;
+    }
+#endif
+    // Without a region of our own, yespower() allocates one on first use.
+    return ctx;
+}
+
+void YespowerContextPool::Free(Context* ctx)
+{
+#if defined(MAP_ANONYMOUS)
+    if (ctx->pool_owned) {
+        munmap(ctx->local.base, ctx->local.base_size);
+        delete ctx;
+        return;
+    }
+#endif
+    yespower_free_local(&ctx->local);
+    delete ctx;
+}
+
+void YespowerContextPool::Untrack(const Context* ctx)
+{
+    m_allocated_bytes -= ctx->size;
+    --m_contexts;
+    if (ctx->huge_pages) --m_huge_page_contexts;
+}
+
+YespowerContextPool::Context* YespowerContextPool::Acquire(size_t need)
+{
+    const size_t size{MappedSize(need)};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // Pool-owned regions must never be resized by yespower(), so only hand
+        // them out for hashes that fit.
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+            if (!(*it)->pool_owned || (*it)->local.aligned_size >= need) {
+                Context* ctx{*it};
+                m_idle.erase(it);
+                return ctx;
+            }
+        }
+        // Idle contexts too small for these parameters make room for a new one.
+        if (!m_idle.empty() && m_allocated_bytes + size > m_max_bytes) {
+            Context* ctx{m_idle.back()};
+            m_idle.pop_back();
+            Untrack(ctx);
+            Free(ctx);
+            continue;
+        }
+        if (m_contexts == 0 || m_allocated_bytes + size <= m_max_bytes) break;
+        m_cond.wait(lock);
+    }
+    // Reserve the memory before allocating so that concurrent callers can't overshoot the cap.
+    m_allocated_bytes += size;
+    ++m_contexts;
+    lock.unlock();
+    Context* ctx{Allocate(need)};
+    lock.lock();
+    m_allocated_bytes = m_allocated_bytes - size + ctx->size;
+    if (ctx->huge_pages) ++m_huge_page_contexts;
+    return ctx;
+}
+
+void YespowerContextPool::Release(Context* ctx)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_allocated_bytes <= m_max_bytes || m_contexts == 1) {
+            m_idle.push_back(ctx);
+            ctx = nullptr;
+        } else {
+            Untrack(ctx);
+        }
+    }
+    m_cond.notify_one();
+    if (ctx) Free(ctx);
+}
+
+int YespowerContextPool::Hash(const uint8_t* src, size_t srclen, const yespower_params_t& params, yespower_binary_t* dst)
+{
+    Context* ctx{Acquire(YespowerScratchSize(params))};
+    const int ret{Yespower(&ctx->local, src, srclen, &params, dst)};
+    Release(ctx);
+    return ret;
+}
+
+void YespowerContextPool::SetMaxBytes(size_t max_bytes)
+{
+    std::vector<Context*> freed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_bytes = max_bytes;
+        while (m_allocated_bytes > m_max_bytes && m_contexts > 1 && !m_idle.empty()) {
+            Context* ctx{m_idle.back()};
+            m_idle.pop_back();
+            Untrack(ctx);
+            freed.push_back(ctx);
+        }
+    }
+    m_cond.notify_all();
+    for (Context* ctx : freed) Free(ctx);
+}
+
+size_t YespowerContextPool::MaxBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_max_bytes;
+}
+
+size_t YespowerContextPool::AllocatedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocated_bytes;
+}
+
+size_t YespowerContextPool::Contexts() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_contexts;
+}
+
+size_t YespowerContextPool::HugePageContexts() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_huge_page_contexts;
+}
+
+YespowerContextPool& GetYespowerContextPool()
+{
+    static YespowerContextPool pool{DEFAULT_MAX_POW_MEMORY << 20};
+    return pool;
+}
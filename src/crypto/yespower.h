@@ -0,0 +1,99 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_YESPOWER_H
+#define BITCOIN_CRYPTO_YESPOWER_H
+
+#include <crypto/yespower-1.0.1/yespower.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* YespowerSugar */
+/** Autodetect the best available yespower implementation.
+ *  Returns the name of the implementation.
+ */
+std::string YespowerAutoDetect();
+
+/** yespower_tls() using the implementation picked by YespowerAutoDetect(). */
+int YespowerTLS(const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+
+/** yespower() using the implementation picked by YespowerAutoDetect(). */
+int Yespower(yespower_local_t* local, const uint8_t* src, size_t srclen, const yespower_params_t* params, yespower_binary_t* dst);
+
+/** Size of the scratch memory yespower() needs for the given parameters. */
+size_t YespowerScratchSize(const yespower_params_t& params);
+
+/** A pool of reusable yespower scratch contexts.
+ *
+ * yespower_tls() keeps several megabytes of scratch memory alive in every
+ * thread that ever computed a hash. This pool instead hands out contexts on
+ * demand and keeps the total scratch memory below a configurable cap: when it
+ * is reached and all contexts are in use, Hash() waits for one to be returned.
+ * One context is always allowed and kept, whatever the cap.
+ *
+ * Scratch memory is allocated up front with huge pages where the OS provides
+ * them (MAP_HUGETLB, falling back to transparent huge pages), which saves most
+ * of the TLB misses of the random reads in the memory-hard phase.
+ */
+class YespowerContextPool
+{
+public:
+    explicit YespowerContextPool(size_t max_bytes);
+    ~YespowerContextPool();
+
+    YespowerContextPool(const YespowerContextPool&) = delete;
+    YespowerContextPool& operator=(const YespowerContextPool&) = delete;
+
+    /** Compute yespower(src[0 .. srclen - 1]) with a context from the pool. Returns 0 on success, -1 on error. */
+    int Hash(const uint8_t* src, size_t srclen, const yespower_params_t& params, yespower_binary_t* dst);
+
+    /** Change the cap. Idle contexts above it are freed right away, busy ones when they are returned. */
+    void SetMaxBytes(size_t max_bytes);
+    size_t MaxBytes() const;
+    /** Scratch memory currently held by the pool, in use or idle. */
+    size_t AllocatedBytes() const;
+    /** Number of contexts currently held by the pool, in use or idle. */
+    size_t Contexts() const;
+    /** Number of those contexts backed by explicit huge pages (MAP_HUGETLB). */
+    size_t HugePageContexts() const;
+
+private:
+    struct Context {
+        yespower_local_t local;
+        /** Bytes accounted against the cap */
+        size_t size;
+        /** Whether local.base was mapped by the pool rather than by yespower() */
+        bool pool_owned;
+        bool huge_pages;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_max_bytes;
+    size_t m_allocated_bytes{0};
+    size_t m_contexts{0};
+    size_t m_huge_page_contexts{0};
+    std::vector<Context*> m_idle;
+
+    Context* Acquire(size_t need);
+    void Release(Context* ctx);
+    /** Remove a context from the accounting. Requires m_mutex. */
+    void Untrack(const Context* ctx);
+    static Context* Allocate(size_t need);
+    static void Free(Context* ctx);
+};
+
+/** Default cap on scratch memory of the global pool, in MiB. Enough for one
+ *  context per PoW check thread plus the message handler thread. */
+static constexpr size_t DEFAULT_MAX_POW_MEMORY{160};
+
+/** The pool used by CBlockHeader::GetPoWHash(). */
+YespowerContextPool& GetYespowerContextPool();
+
+#endif // BITCOIN_CRYPTO_YESPOWER_H
@@ -0,0 +1,19 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* YespowerSugar */
+// yespower-opt.c built with AVX enabled. The public functions are
+// renamed so that every variant can be linked into the same binary; see
+// crypto/yespower.cpp for the runtime selection.
+
+#ifdef ENABLE_AVX
+
+#define yespower yespower_avx
+#define yespower_tls yespower_tls_avx
+#define yespower_init_local yespower_init_local_avx
+#define yespower_free_local yespower_free_local_avx
+
+#include "yespower-1.0.1/yespower-opt.c"
+
+#endif
@@ -251,10 +251,17 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+CDBSnapshot::CDBSnapshot(const CDBWrapper& parent)
+    : m_parent{parent}, m_snapshot{parent.pdb->GetSnapshot()} {}
+
+CDBSnapshot::~CDBSnapshot() { m_parent.pdb->ReleaseSnapshot(m_snapshot); }
+
 CDBIterator::~CDBIterator() { delete piter; }
 bool CDBIterator::Valid() const { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
+void CDBIterator::SeekToLast() { piter->SeekToLast(); }
 void CDBIterator::Next() { piter->Next(); }
+void CDBIterator::Prev() { piter->Prev(); }
 
 namespace dbwrapper_private {
 
@@ -172,6 +172,7 @@ public:
     bool Valid() const;
 
     void SeekToFirst();
+    void SeekToLast();
 
     template<typename K> void Seek(const K& key) {
         DataStream ssKey{};
@@ -182,6 +183,7 @@ public:
     }
 
     void Next();
+    void Prev();
 
     template<typename K> bool GetKey(K& key) {
         leveldb::Slice slKey = piter->key();
@@ -207,9 +209,33 @@ public:
     }
 };
 
+/* YespowerSugar */
+/**
+ * A view of the database as of the time it was taken. Reads and iterators
+ * given the snapshot see neither the batches written after it nor each
+ * other's progress, so several of them read one consistent state, also from
+ * different threads.
+ */
+class CDBSnapshot
+{
+private:
+    const CDBWrapper& m_parent;
+    const leveldb::Snapshot* m_snapshot;
+
+public:
+    explicit CDBSnapshot(const CDBWrapper& parent);
+    ~CDBSnapshot();
+
+    CDBSnapshot(const CDBSnapshot&) = delete;
+    CDBSnapshot& operator=(const CDBSnapshot&) = delete;
+
+    const leveldb::Snapshot* get() const { return m_snapshot; }
+};
+
 class CDBWrapper
 {
     friend const std::vector<unsigned char>& dbwrapper_private::GetObfuscateKey(const CDBWrapper &w);
+    friend class CDBSnapshot;
 private:
     //! custom environment this database is using (may be nullptr in case of default environment)
     leveldb::Env* penv;
@@ -260,15 +286,17 @@ public:
     CDBWrapper& operator=(const CDBWrapper&) = delete;
 
     template <typename K, typename V>
-    bool Read(const K& key, V& value) const
+    bool Read(const K& key, V& value, const CDBSnapshot* snapshot = nullptr) const
     {
         DataStream ssKey{};
         ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
         ssKey << key;
         leveldb::Slice slKey((const char*)ssKey.data(), ssKey.size());
 
+        leveldb::ReadOptions options{readoptions};
+        if (snapshot) options.snapshot = snapshot->get();
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(options, slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -333,9 +361,11 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
-    CDBIterator *NewIterator()
+    CDBIterator *NewIterator(const CDBSnapshot* snapshot = nullptr)
     {
-        return new CDBIterator(*this, pdb->NewIterator(iteroptions));
+        leveldb::ReadOptions options{iteroptions};
+        if (snapshot) options.snapshot = snapshot->get();
+        return new CDBIterator(*this, pdb->NewIterator(options));
     }
 
     /**
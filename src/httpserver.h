@@ -5,6 +5,9 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <span.h>
+
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string>
@@ -123,7 +126,10 @@ public:
      * @note Can be called only once. As this will give the request back to the
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
-    void WriteReply(int nStatus, const std::string& strReply = "");
+    void WriteReply(int nStatus, const std::string& strReply = "") { WriteReply(nStatus, MakeByteSpan(strReply)); }
+    /* YespowerSugar */
+    /** Write HTTP reply with a binary body, without copying it into a string first. */
+    void WriteReply(int nStatus, Span<const std::byte> reply);
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
@@ -7,6 +7,7 @@
 #include <interfaces/chain.h>
 #include <kernel/chain.h>
 #include <logging.h>
+#include <node/blockprefetch.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/database_args.h>
@@ -29,6 +30,9 @@ constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+/* YespowerSugar */
+//! Threads reading blocks ahead of an index sync, which only deserializes them
+constexpr int INDEX_PREFETCH_THREADS{2};
 
 template <typename... Args>
 static void FatalError(const char* fmt, const Args&... args)
@@ -161,8 +165,28 @@ void BaseIndex::ThreadSync()
     if (!m_synced) {
         auto& consensus_params = Params().GetConsensus();
 
+        if (!pindex) {
+            if (!CustomBulkSync(pindex)) {
+                FatalError("%s: Failed to build index %s in bulk", __func__, GetName());
+                return;
+            }
+            if (pindex) {
+                SetBestBlockIndex(pindex);
+                // No need to handle errors in Commit. See rationale below.
+                Commit();
+            }
+        }
+
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
+        /* YespowerSugar */
+        // The next blocks of the active chain are read ahead while the ones
+        // before them are indexed.
+        std::unique_ptr<node::BlockPrefetcher> prefetcher;
+        if (const int depth{m_chainstate->m_chainman.m_options.block_prefetch}; depth > 0) {
+            prefetcher = std::make_unique<node::BlockPrefetcher>(consensus_params, depth, INDEX_PREFETCH_THREADS);
+        }
+        const CBlockIndex* pindex_prefetched{nullptr};
         while (true) {
             if (m_interrupt) {
                 SetBestBlockIndex(pindex);
@@ -189,6 +213,19 @@ void BaseIndex::ThreadSync()
                     return;
                 }
                 pindex = pindex_next;
+
+                /* YespowerSugar */
+                if (prefetcher) {
+                    CChain& chain{m_chainstate->m_chain};
+                    if (pindex_prefetched && (pindex_prefetched->nHeight < pindex->nHeight || !chain.Contains(pindex_prefetched))) {
+                        pindex_prefetched = nullptr;
+                    }
+                    for (const CBlockIndex* next{pindex_prefetched ? chain.Next(pindex_prefetched) : pindex};
+                         next && (next->nStatus & BLOCK_HAVE_DATA) && prefetcher->Prefetch(next->GetBlockHash(), next->GetBlockPos());
+                         next = chain.Next(next)) {
+                        pindex_prefetched = next;
+                    }
+                }
             }
 
             auto current_time{std::chrono::steady_clock::now()};
@@ -205,15 +242,18 @@ void BaseIndex::ThreadSync()
                 Commit();
             }
 
-            CBlock block;
             interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex);
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
-                FatalError("%s: Failed to read block %s from disk",
-                           __func__, pindex->GetBlockHash().ToString());
-                return;
-            } else {
-                block_info.data = &block;
+            std::shared_ptr<const CBlock> block{prefetcher ? prefetcher->Take(pindex->GetBlockHash()) : nullptr}; /* YespowerSugar */
+            if (!block) {
+                auto block_read{std::make_shared<CBlock>()};
+                if (!ReadBlockFromDisk(*block_read, pindex, consensus_params)) {
+                    FatalError("%s: Failed to read block %s from disk",
+                               __func__, pindex->GetBlockHash().ToString());
+                    return;
+                }
+                block = std::move(block_read);
             }
+            block_info.data = block.get();
             if (!CustomAppend(block_info)) {
                 FatalError("%s: Failed to write block %s to index database",
                            __func__, pindex->GetBlockHash().ToString());
@@ -318,6 +358,24 @@ void BaseIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const
     }
 }
 
+void BaseIndex::RewindDisconnectedBlock(const CBlockIndex* pindex)
+{
+    if (!m_synced) {
+        return;
+    }
+
+    // Blocks further back than the best block can show up here while the sync
+    // thread hands over to the notification queue; the rewind in
+    // BlockConnected takes care of those.
+    if (m_best_block_index.load() != pindex || !pindex->pprev) {
+        return;
+    }
+    if (!Rewind(pindex, pindex->pprev)) {
+        FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                   __func__, GetName());
+    }
+}
+
 void BaseIndex::ChainStateFlushed(const CBlockLocator& locator)
 {
     if (!m_synced) {
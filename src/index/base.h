@@ -103,12 +103,24 @@ protected:
 
     void ChainStateFlushed(const CBlockLocator& locator) override;
 
+    /// Rewind the index off a block that was disconnected from the active
+    /// chain if it is the current best block. Indexes that must not serve
+    /// data of stale blocks call this from BlockDisconnected rather than
+    /// waiting for the next BlockConnected to trigger the rewind.
+    void RewindDisconnectedBlock(const CBlockIndex* pindex);
+
     /// Initialize internal state from the database and block index.
     [[nodiscard]] virtual bool CustomInit(const std::optional<interfaces::BlockKey>& block) { return true; }
 
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Build the index up to a block of the active chain in one go rather
+    /// than block by block. Called from the sync thread while the index has
+    /// no best block; sets pindex to the block the index was built up to, or
+    /// leaves it null to sync from the genesis block.
+    [[nodiscard]] virtual bool CustomBulkSync(const CBlockIndex*& pindex) { return true; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -122,6 +134,10 @@ protected:
     /// Get the name of the index for display in logs.
     const std::string& GetName() const LIFETIMEBOUND { return m_name; }
 
+    /// Whether the sync thread was asked to stop, for long running work in
+    /// CustomBulkSync.
+    bool IsInterrupted() const { return static_cast<bool>(m_interrupt); }
+
     /// Update the internal best block index as well as the prune lock.
     void SetBestBlockIndex(const CBlockIndex* block);
 
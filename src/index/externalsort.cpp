@@ -0,0 +1,105 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/externalsort.h>
+
+#include <logging.h>
+#include <util/fs_helpers.h>
+
+#include <algorithm>
+#include <ios>
+
+/** Start of every run file, followed by its height ranges. */
+static constexpr uint32_t SORTED_RUN_MAGIC{0x53525431};
+
+static fs::path TempRunPath(const fs::path& path)
+{
+    return fs::PathFromString(fs::PathToString(path) + ".tmp");
+}
+
+SortedRunWriter::SortedRunWriter(const fs::path& path, const HeightRanges& ranges)
+    : m_path{path}, m_file{fsbridge::fopen(TempRunPath(path), "wb")}
+{
+    m_file << SORTED_RUN_MAGIC << ranges;
+}
+
+bool SortedRunWriter::Commit()
+{
+    // A record without key ends the run, so truncated runs are detected.
+    m_file << SortedRecord{};
+    if (!FileCommit(m_file.Get()) || m_file.fclose() != 0) {
+        return error("%s: failed to write %s", __func__, fs::PathToString(m_path));
+    }
+    return RenameOver(TempRunPath(m_path), m_path);
+}
+
+SortedRunReader::SortedRunReader(const fs::path& path)
+    : m_file{fsbridge::fopen(path, "rb")}
+{
+    uint32_t magic;
+    m_file >> magic;
+    if (magic != SORTED_RUN_MAGIC) {
+        throw std::ios_base::failure("not a sorted run");
+    }
+    m_file >> m_ranges;
+}
+
+bool SortedRunReader::Next(SortedRecord& record)
+{
+    m_file >> record;
+    return !record.key.empty();
+}
+
+bool WriteSortedRun(const fs::path& path, const HeightRanges& ranges, std::vector<SortedRecord>& records)
+{
+    std::sort(records.begin(), records.end());
+    SortedRunWriter writer{path, ranges};
+    for (const SortedRecord& record : records) {
+        writer.Write(record);
+    }
+    return writer.Commit();
+}
+
+bool MergeSortedRuns(const std::vector<std::unique_ptr<SortedRunReader>>& runs, const std::function<bool(SortedRecord& record)>& emit)
+{
+    struct Head {
+        SortedRecord record;
+        size_t run;
+    };
+    // The heap functions keep the largest element in front, so the
+    // comparison is reversed to take the records in ascending order.
+    const auto after{[](const Head& a, const Head& b) { return b.record < a.record; }};
+    std::vector<Head> heads;
+    heads.reserve(runs.size());
+
+    const auto advance{[&](size_t run) {
+        Head head{{}, run};
+        if (runs[run]->Next(head.record)) {
+            heads.push_back(std::move(head));
+            std::push_heap(heads.begin(), heads.end(), after);
+        }
+    }};
+    const auto pop{[&]() {
+        std::pop_heap(heads.begin(), heads.end(), after);
+        SortedRecord record{std::move(heads.back().record)};
+        const size_t run{heads.back().run};
+        heads.pop_back();
+        advance(run);
+        return record;
+    }};
+
+    for (size_t run = 0; run < runs.size(); ++run) {
+        advance(run);
+    }
+    while (!heads.empty()) {
+        SortedRecord record{pop()};
+        // The records of a key come out by increasing order, so the last of
+        // them is the one that takes effect.
+        while (!heads.empty() && heads.front().record.key == record.key) {
+            record = pop();
+        }
+        if (!emit(record)) return false;
+    }
+    return true;
+}
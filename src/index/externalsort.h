@@ -0,0 +1,92 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_EXTERNALSORT_H
+#define BITCOIN_INDEX_EXTERNALSORT_H
+
+#include <serialize.h>
+#include <streams.h>
+#include <util/fs.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Sorted runs for building an index database in bulk.
+ *
+ * The entries of many blocks are collected as serialized key/value records,
+ * sorted in LevelDB's bytewise key order and spilled to run files, which are
+ * merged back into one ordered stream. Loading that stream in large batches
+ * costs LevelDB far less compaction than a small unsorted batch per block.
+ */
+
+/** A database entry, or with erase set the removal of it. Of several records
+ *  with the same key the one with the highest order takes effect. */
+struct SortedRecord {
+    std::vector<unsigned char> key;
+    std::vector<unsigned char> value;
+    uint64_t order{0};
+    bool erase{false};
+
+    SERIALIZE_METHODS(SortedRecord, obj) { READWRITE(obj.key, obj.value, obj.order, obj.erase); }
+
+    friend bool operator<(const SortedRecord& a, const SortedRecord& b)
+    {
+        return std::tie(a.key, a.order) < std::tie(b.key, b.order);
+    }
+};
+
+/** Inclusive ranges of the block heights whose records a run holds. */
+using HeightRanges = std::vector<std::pair<int, int>>;
+
+/** Writes records, which must already be sorted, to a run file. The file only
+ *  shows up under its name once Commit succeeded. Writes throw
+ *  std::ios_base::failure on I/O errors. */
+class SortedRunWriter
+{
+private:
+    fs::path m_path;
+    AutoFile m_file;
+
+public:
+    SortedRunWriter(const fs::path& path, const HeightRanges& ranges);
+
+    void Write(const SortedRecord& record) { m_file << record; }
+
+    /** Flush the run to disk and move it into place. */
+    bool Commit();
+};
+
+/** Reads the records of a run file in order. Throws std::ios_base::failure
+ *  if the file is not a complete run. */
+class SortedRunReader
+{
+private:
+    AutoFile m_file;
+    HeightRanges m_ranges;
+
+public:
+    explicit SortedRunReader(const fs::path& path);
+
+    const HeightRanges& Ranges() const { return m_ranges; }
+
+    /** Read the next record. Returns false at the end of the run. */
+    bool Next(SortedRecord& record);
+};
+
+/** Sort records and write them as a run file. */
+bool WriteSortedRun(const fs::path& path, const HeightRanges& ranges, std::vector<SortedRecord>& records);
+
+/**
+ * Merge runs into one stream in key order, passing emit the record with the
+ * highest order of each key, erase records included. Returns false as soon as
+ * emit does. Throws std::ios_base::failure if a run cannot be read.
+ */
+bool MergeSortedRuns(const std::vector<std::unique_ptr<SortedRunReader>>& runs, const std::function<bool(SortedRecord& record)>& emit);
+
+#endif // BITCOIN_INDEX_EXTERNALSORT_H
@@ -0,0 +1,1381 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/insightindex.h>
+
+#include <addressnotifier.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <consensus/consensus.h>
+#include <index/externalsort.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <shutdown.h>
+#include <sync.h>
+#include <txdb.h>
+#include <undo.h>
+#include <util/fs_helpers.h>
+#include <util/syscall_sandbox.h>
+#include <util/system.h>
+#include <util/threadnames.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+
+using node::ReadBlockFromDisk;
+using node::UndoReadFromDisk;
+
+static constexpr uint8_t DB_ADDRESSINDEX{'a'};
+static constexpr uint8_t DB_ADDRESSUNSPENTINDEX{'u'};
+static constexpr uint8_t DB_TIMESTAMPINDEX{'s'};
+static constexpr uint8_t DB_SPENTINDEX{'p'};
+static constexpr uint8_t DB_ADDRESSBALANCE{'b'};
+static constexpr uint8_t DB_INDEX_FLAGS{'F'};
+static constexpr uint8_t DB_INDEX_VERSION{'V'};
+static constexpr uint8_t DB_BEST_BLOCK{'T'};
+
+static constexpr uint8_t INDEX_FLAG_ADDRESS{1 << 0};
+static constexpr uint8_t INDEX_FLAG_SPENT{1 << 1};
+static constexpr uint8_t INDEX_FLAG_TIMESTAMP{1 << 2};
+static constexpr uint8_t INDEX_FLAG_ADDRESS_BALANCE{1 << 3};
+
+/** Format of the keys and values, see spentindex.h. Version 1 is the encoding
+ *  of the entries that earlier versions kept in blocks/index. */
+static constexpr int INDEX_VERSION{2};
+/** Recorded while the entries of blocks/index are migrated, so an interrupted
+ *  migration is detected. */
+static constexpr int INDEX_VERSION_MIGRATING{-1};
+/** Recorded while a bulk build loads the database, so an interrupted load is
+ *  started over on an empty database. */
+static constexpr int INDEX_VERSION_BULK_LOADING{-2};
+
+/** Rough memory the bulk build records of an average transaction take, for
+ *  sizing the ranges of blocks scanned at once. */
+static constexpr size_t BULK_BYTES_PER_TX{2048};
+/** Most runs merged at once. More are merged into larger runs first, which
+ *  bounds the number of open files. */
+static constexpr size_t MAX_BULK_MERGE_RUNS{64};
+/** Size of the batches a bulk build loads the database with. */
+static constexpr size_t BULK_BATCH_SIZE{64 << 20};
+static constexpr auto BULK_LOG_INTERVAL{std::chrono::seconds{30}};
+
+/** Coinbase outputs are dropped from an address balance record once they are
+ *  this deep. Anything younger than COINBASE_MATURITY is immature; the rest of
+ *  the window keeps the immature balance exact across reorgs of up to
+ *  COINBASE_MATURITY blocks. */
+static constexpr int RECENT_COINBASE_DEPTH{2 * COINBASE_MATURITY};
+
+std::unique_ptr<InsightIndex> g_insightindex;
+
+static fs::path BulkBuildDir()
+{
+    return gArgs.GetDataDirNet() / "indexes" / "insight_bulk";
+}
+
+/**
+ * Threads that help callers through batches of independent work. Every batch
+ * keeps its own state and its caller works through it as well, so concurrent
+ * batches share the threads without waiting on each other: a slow batch only
+ * holds up the threads that already took part of it.
+ */
+class IndexReadPool
+{
+private:
+    /** The positions of one batch, which the caller and any threads that
+     *  pick it up take one at a time. */
+    struct Batch {
+        const std::function<bool(size_t)>* const work;
+        const size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<bool> ok{true};
+        Mutex mutex;
+        std::condition_variable cv;
+        //! Threads working through the batch
+        int running GUARDED_BY(mutex){0};
+
+        Batch(const std::function<bool(size_t)>& work_in, size_t count_in) : work{&work_in}, count{count_in} {}
+
+        /** Run positions until none are left. A thread that comes too late
+         *  takes none, and never calls work, which may be gone by then. */
+        void Run() EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+        {
+            WITH_LOCK(mutex, ++running);
+            for (size_t pos; (pos = next++) < count;) {
+                if (ok && !(*work)(pos)) ok = false;
+            }
+            LOCK(mutex);
+            if (--running == 0) cv.notify_all();
+        }
+    };
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::shared_ptr<Batch>> m_queue GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            std::shared_ptr<Batch> batch;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+                if (m_stop) return;
+                batch = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            batch->Run();
+        }
+    }
+
+public:
+    ~IndexReadPool() { Stop(); }
+
+    void Start(int threads_num, const std::string& thread_name, SyscallSandboxPolicy policy) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        assert(m_threads.empty());
+        WITH_LOCK(m_mutex, m_stop = false);
+        for (int n = 0; n < threads_num; ++n) {
+            m_threads.emplace_back([this, n, thread_name, policy]() {
+                util::ThreadRename(strprintf("%s.%i", thread_name, n));
+                SetSyscallSandboxPolicy(policy);
+                Loop();
+            });
+        }
+    }
+
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+        m_threads.clear();
+        WITH_LOCK(m_mutex, m_queue.clear());
+    }
+
+    int ThreadCount() const { return m_threads.size(); }
+
+    /** Call work(pos) for every pos below count, spread over the threads and
+     *  the calling thread. Returns false if any call returned false. */
+    bool Run(size_t count, const std::function<bool(size_t)>& work) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (count < 2 || m_threads.empty()) {
+            for (size_t pos = 0; pos < count; ++pos) {
+                if (!work(pos)) return false;
+            }
+            return true;
+        }
+
+        const auto batch{std::make_shared<Batch>(work, count)};
+        {
+            LOCK(m_mutex);
+            for (size_t i = 0; i < std::min(count - 1, m_threads.size()); ++i) {
+                m_queue.push_back(batch);
+            }
+        }
+        m_cv.notify_all();
+        batch->Run();
+        // All positions are taken, wait for the threads still running some.
+        WAIT_LOCK(batch->mutex, lock);
+        batch->cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(batch->mutex) { return batch->running == 0; });
+        return batch->ok;
+    }
+};
+
+/** Helps the RPC and REST threads through multi-address reads. */
+static IndexReadPool g_index_read_pool;
+
+void StartIndexReadWorkerThreads(int threads_num)
+{
+    // The readers run the same LevelDB reads as the HTTP workers they serve.
+    g_index_read_pool.Start(threads_num, "idxread", SyscallSandboxPolicy::NET_HTTP_SERVER_WORKER);
+}
+
+void StopIndexReadWorkerThreads()
+{
+    g_index_read_pool.Stop();
+}
+
+/** Access to the address, spent and timestamp index database (indexes/insight/) */
+class InsightIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the set of indexes the database was built with.
+    bool ReadIndexFlags(uint8_t& flags) const;
+    bool WriteIndexFlags(uint8_t flags);
+
+    bool ReadIndexVersion(int& version) const;
+    bool WriteIndexVersion(int version);
+
+    bool ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+    bool ScanAddressUnspentIndex(const uint256& address_hash, int type, const CAddressUnspentKey* after,
+                                 const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& visit,
+                                 const CDBSnapshot* snapshot);
+    bool ScanAddressIndex(const uint256& address_hash, int type, const CAddressIndexKey* after, int start, int end,
+                          const std::function<bool(const CAddressIndexKey&, CAmount)>& visit, const CDBSnapshot* snapshot);
+    bool ReadTimestampIndex(unsigned int high, unsigned int low, std::vector<std::pair<uint256, unsigned int>>& vect);
+    bool ReadAddressBalance(const uint256& address_hash, int type, CAddressBalanceValue& value, const CDBSnapshot* snapshot = nullptr) const;
+
+    /// Read the block the entries are up to date with. Unlike the locator of
+    /// BaseIndex it is written in the same batch as the entries of the block.
+    bool ReadBestBlock(interfaces::BlockKey& block, const CDBSnapshot* snapshot = nullptr) const;
+    static void WriteBestBlock(CDBBatch& batch, const interfaces::BlockKey& block);
+
+    /// Find the highest block below before_height in which the address has
+    /// activity. Returns 0 if there is none.
+    int ReadLastAddressHeight(const uint256& address_hash, int type, int before_height);
+};
+
+InsightIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "insight", n_cache_size, f_memory, f_wipe)
+{}
+
+bool InsightIndex::DB::ReadIndexFlags(uint8_t& flags) const
+{
+    return Read(DB_INDEX_FLAGS, flags);
+}
+
+bool InsightIndex::DB::WriteIndexFlags(uint8_t flags)
+{
+    return Write(DB_INDEX_FLAGS, flags);
+}
+
+bool InsightIndex::DB::ReadIndexVersion(int& version) const
+{
+    return Read(DB_INDEX_VERSION, version);
+}
+
+bool InsightIndex::DB::WriteIndexVersion(int version)
+{
+    return Write(DB_INDEX_VERSION, version);
+}
+
+namespace {
+/** A key or value in the version 1 encoding. */
+template <typename T>
+struct Legacy {
+    T obj;
+    SERIALIZE_METHODS(Legacy, o) { READWRITE(Using<LegacyIndexFormatter>(o.obj)); }
+};
+} // namespace
+
+/** Erase the entries with one key prefix that earlier versions kept in
+ *  blocks/index, copying them to db in the current encoding unless it is null.
+ *  The copies are written before the originals are erased. */
+template <typename Key, typename Value>
+static bool MoveLegacyEntries(CDBWrapper& legacy_db, CDBWrapper* db, uint8_t prefix, uint64_t& count)
+{
+    std::unique_ptr<CDBIterator> pcursor(legacy_db.NewIterator());
+    pcursor->Seek(prefix);
+
+    CDBBatch erase_batch(legacy_db);
+    std::optional<CDBBatch> batch;
+    if (db) batch.emplace(*db);
+    const auto write{[&] {
+        if (batch && !db->WriteBatch(*batch)) return false;
+        return legacy_db.WriteBatch(erase_batch);
+    }};
+    while (pcursor->Valid()) {
+        if (ShutdownRequested()) return false;
+        std::pair<uint8_t, Legacy<Key>> key;
+        if (!pcursor->GetKey(key) || key.first != prefix) break;
+        if (batch) {
+            Legacy<Value> value;
+            if (!pcursor->GetValue(value)) {
+                return error("%s: failed to read entry %c", __func__, prefix);
+            }
+            batch->Write(std::make_pair(prefix, key.second.obj), value.obj);
+        }
+        erase_batch.Erase(key);
+        if (++count % 1000000 == 0) {
+            LogPrintf("Migrating the block index database: %u entries\n", count);
+        }
+        if (erase_batch.SizeEstimate() > (16 << 20)) {
+            if (!write()) return false;
+            erase_batch.Clear();
+            if (batch) batch->Clear();
+        }
+        pcursor->Next();
+    }
+    return write();
+}
+
+static bool HasLegacyInsightEntries(CDBWrapper& block_tree_db)
+{
+    std::unique_ptr<CDBIterator> pcursor(block_tree_db.NewIterator());
+    for (const uint8_t prefix : {DB_ADDRESSINDEX, DB_ADDRESSUNSPENTINDEX, DB_SPENTINDEX, DB_TIMESTAMPINDEX}) {
+        pcursor->Seek(prefix);
+        uint8_t key;
+        if (pcursor->Valid() && pcursor->GetKey(key) && key == prefix) return true;
+    }
+    return false;
+}
+
+/** Erase the legacy entries of all indexes, copying those of the enabled ones
+ *  to db unless it is null. */
+static bool MoveLegacyInsightEntries(CBlockTreeDB& block_tree_db, CDBWrapper* db, uint64_t& count)
+{
+    // The flags tell that the legacy indexes are complete, which they no
+    // longer are once the first entries are erased.
+    for (const std::string flag : {"addressindex", "spentindex", "timestampindex"}) {
+        if (!block_tree_db.WriteFlag(flag, false)) return false;
+    }
+    return MoveLegacyEntries<CAddressIndexKey, CAmount>(block_tree_db, fAddressIndex ? db : nullptr, DB_ADDRESSINDEX, count) &&
+           MoveLegacyEntries<CAddressUnspentKey, CAddressUnspentValue>(block_tree_db, fAddressIndex ? db : nullptr, DB_ADDRESSUNSPENTINDEX, count) &&
+           MoveLegacyEntries<CSpentIndexKey, CSpentIndexValue>(block_tree_db, fSpentIndex ? db : nullptr, DB_SPENTINDEX, count) &&
+           MoveLegacyEntries<CTimestampIndexKey, int>(block_tree_db, fTimestampIndex ? db : nullptr, DB_TIMESTAMPINDEX, count);
+}
+
+bool EraseLegacyInsightEntries(CBlockTreeDB& block_tree_db)
+{
+    if (!HasLegacyInsightEntries(block_tree_db)) return true;
+    LogPrintf("Erasing the address, spent and timestamp index entries of the block index database\n");
+    uint64_t count{0};
+    if (!MoveLegacyInsightEntries(block_tree_db, nullptr, count)) return false;
+    LogPrintf("Erased %u index entries of the block index database\n", count);
+    return true;
+}
+
+bool InsightIndex::DB::ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    return Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
+
+bool InsightIndex::DB::ScanAddressUnspentIndex(const uint256& address_hash, int type, const CAddressUnspentKey* after,
+                                               const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& visit,
+                                               const CDBSnapshot* snapshot)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator(snapshot));
+
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, *after));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, address_hash)));
+    }
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENTINDEX ||
+            key.second.type != (unsigned int)type || key.second.hashBytes != address_hash) {
+            break;
+        }
+        if (after && key.second == *after) {
+            pcursor->Next();
+            continue;
+        }
+        CAddressUnspentValue value;
+        if (!pcursor->GetValue(value)) {
+            return error("failed to get address unspent value");
+        }
+        if (!visit(key.second, value)) break;
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+bool InsightIndex::DB::ScanAddressIndex(const uint256& address_hash, int type, const CAddressIndexKey* after,
+                                        int start, int end,
+                                        const std::function<bool(const CAddressIndexKey&, CAmount)>& visit,
+                                        const CDBSnapshot* snapshot)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator(snapshot));
+
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, *after));
+    } else if (start > 0 && end > 0) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, address_hash, start)));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, address_hash)));
+    }
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX ||
+            key.second.type != (unsigned int)type || key.second.hashBytes != address_hash) {
+            break;
+        }
+        if (end > 0 && key.second.blockHeight > end) {
+            break;
+        }
+        if (after && key.second == *after) {
+            pcursor->Next();
+            continue;
+        }
+        CAmount value;
+        if (!pcursor->GetValue(value)) {
+            return error("failed to get address index value");
+        }
+        if (!visit(key.second, value)) break;
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+bool InsightIndex::DB::ReadTimestampIndex(unsigned int high, unsigned int low, std::vector<std::pair<uint256, unsigned int>>& vect)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+
+    while (pcursor->Valid()) {
+        if (ShutdownRequested()) return false;
+        std::pair<uint8_t, CTimestampIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
+            vect.emplace_back(key.second.blockHash, key.second.timestamp);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool InsightIndex::DB::ReadAddressBalance(const uint256& address_hash, int type, CAddressBalanceValue& value, const CDBSnapshot* snapshot) const
+{
+    return Read(std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(type, address_hash)), value, snapshot);
+}
+
+bool InsightIndex::DB::ReadBestBlock(interfaces::BlockKey& block, const CDBSnapshot* snapshot) const
+{
+    std::pair<uint256, int> value;
+    if (!Read(DB_BEST_BLOCK, value, snapshot)) return false;
+    block = {value.first, value.second};
+    return true;
+}
+
+void InsightIndex::DB::WriteBestBlock(CDBBatch& batch, const interfaces::BlockKey& block)
+{
+    batch.Write(DB_BEST_BLOCK, std::make_pair(block.hash, block.height));
+}
+
+int InsightIndex::DB::ReadLastAddressHeight(const uint256& address_hash, int type, int before_height)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    // The entries of an address are ordered by height, so the last one below
+    // before_height is the one before the first entry at or above it.
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, address_hash, before_height)));
+    if (pcursor->Valid()) {
+        pcursor->Prev();
+    } else {
+        pcursor->SeekToLast();
+    }
+
+    std::pair<uint8_t, CAddressIndexKey> key;
+    if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX &&
+        key.second.type == (unsigned int)type && key.second.hashBytes == address_hash) {
+        return key.second.blockHeight;
+    }
+    return 0;
+}
+
+static uint8_t EnabledIndexFlags()
+{
+    return (fAddressIndex ? INDEX_FLAG_ADDRESS | INDEX_FLAG_ADDRESS_BALANCE : 0) |
+           (fSpentIndex ? INDEX_FLAG_SPENT : 0) |
+           (fTimestampIndex ? INDEX_FLAG_TIMESTAMP : 0);
+}
+
+InsightIndex::InsightIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "insightindex"), m_db(std::make_unique<InsightIndex::DB>(n_cache_size, f_memory, f_wipe)),
+      m_bulk_memory{n_cache_size}
+{
+    const uint8_t flags{EnabledIndexFlags()};
+    uint8_t db_flags;
+    bool rebuild{false};
+    if (m_db->ReadIndexFlags(db_flags)) {
+        int version{0};
+        m_db->ReadIndexVersion(version);
+        if (db_flags != flags) {
+            LogPrintf("%s: Enabled address/spent/timestamp indexes changed, rebuilding %s\n", __func__, GetName());
+            rebuild = true;
+        } else if (version == INDEX_VERSION_MIGRATING) {
+            LogPrintf("%s: Migration of %s was interrupted, rebuilding\n", __func__, GetName());
+            rebuild = true;
+        } else if (version == INDEX_VERSION_BULK_LOADING) {
+            LogPrintf("%s: Bulk build of %s was interrupted, loading it again\n", __func__, GetName());
+            rebuild = true;
+        } else if (version != INDEX_VERSION) {
+            LogPrintf("%s: Unknown format version %d of %s, rebuilding\n", __func__, version, GetName());
+            rebuild = true;
+        }
+    }
+    if (rebuild) {
+        m_db.reset();
+        m_db = std::make_unique<InsightIndex::DB>(n_cache_size, f_memory, /*f_wipe=*/true);
+    }
+    m_db->WriteIndexFlags(flags);
+    m_db->WriteIndexVersion(INDEX_VERSION);
+}
+
+InsightIndex::~InsightIndex() = default;
+
+void ActiveChainTimes::SetTip(const CBlockIndex* pindex)
+{
+    LOCK(m_mutex);
+    if (pindex == nullptr) {
+        m_chain.clear();
+        return;
+    }
+    m_chain.resize(pindex->nHeight + 1);
+    while (pindex && m_chain[pindex->nHeight] != pindex) {
+        m_chain[pindex->nHeight] = pindex;
+        pindex = pindex->pprev;
+    }
+}
+
+void ActiveChainTimes::FindBlocks(unsigned int high, unsigned int low, std::vector<std::pair<uint256, unsigned int>>& blocks) const
+{
+    LOCK(m_mutex);
+    if (m_chain.size() < 2) return;
+
+    // Every block before the first one with nTimeMax >= low is older than low.
+    auto it{std::lower_bound(m_chain.begin() + 1, m_chain.end(), low, [](const CBlockIndex* pindex, unsigned int time) {
+        return pindex->nTimeMax < time;
+    })};
+    for (; it != m_chain.end(); ++it) {
+        const CBlockIndex* pindex{*it};
+        if (pindex->nTime < high) {
+            if (pindex->nTime >= low) blocks.emplace_back(pindex->GetBlockHash(), pindex->nTime);
+        } else if (pindex->GetMedianTimePast() >= high) {
+            // Later blocks are newer than the median time past of this one.
+            break;
+        }
+    }
+}
+
+namespace {
+/** Changes a single block makes to one address balance record. */
+struct BalanceDelta {
+    CAmount balance{0};
+    CAmount received{0};
+    CAmount coinbase{0};
+    uint64_t tx_count{0};
+    uint256 last_tx;
+
+    void AddTx(const uint256& txhash)
+    {
+        if (tx_count == 0 || last_tx != txhash) {
+            last_tx = txhash;
+            ++tx_count;
+        }
+    }
+};
+
+/** Folds the address index entries, visited in key order, into the balance
+ *  record of each address. */
+class BalanceFolder
+{
+private:
+    std::optional<std::pair<unsigned int, uint256>> m_address;
+    BalanceDelta m_total;
+    CAddressBalanceValue m_balance;
+
+    void PruneCoinbase()
+    {
+        auto& recent{m_balance.recentCoinbase};
+        recent.erase(recent.begin(), std::find_if(recent.begin(), recent.end(), [&](const auto& entry) {
+            return entry.first > m_balance.lastHeight - RECENT_COINBASE_DEPTH;
+        }));
+    }
+
+public:
+    /** Add an entry. The record of the previous address is written to batch
+     *  when the entries of the next one start. */
+    void Add(CDBBatch& batch, const CAddressIndexKey& entry, CAmount amount)
+    {
+        if (!m_address || m_address->first != entry.type || m_address->second != entry.hashBytes) {
+            Finish(batch);
+            m_address.emplace(entry.type, entry.hashBytes);
+            m_total = BalanceDelta{};
+            m_balance.SetNull();
+        }
+        m_total.balance += amount;
+        if (!entry.spending) m_total.received += amount;
+        m_total.AddTx(entry.txhash);
+        m_balance.lastHeight = entry.blockHeight;
+        // The coinbase transaction is the first of its block.
+        if (entry.txindex == 0 && !entry.spending) {
+            auto& recent{m_balance.recentCoinbase};
+            if (recent.empty() || recent.back().first != entry.blockHeight) {
+                recent.emplace_back(entry.blockHeight, 0);
+                PruneCoinbase();
+            }
+            recent.back().second += amount;
+        }
+    }
+
+    /** Write the record of the last address added. */
+    void Finish(CDBBatch& batch)
+    {
+        if (!m_address) return;
+        m_balance.balance = m_total.balance;
+        m_balance.received = m_total.received;
+        m_balance.txCount = m_total.tx_count;
+        PruneCoinbase();
+        batch.Write(std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(m_address->first, m_address->second)), m_balance);
+        m_address.reset();
+    }
+};
+} // namespace
+
+/** Changes of the blocks of a batch to the address balance records. */
+using BalanceDeltas = std::map<std::pair<unsigned int, uint256>, BalanceDelta>;
+
+/** Add (or with disconnect set, remove) the address, unspent and spent index
+ *  entries of one block to batch, which is a CDBBatch or anything else with
+ *  its Write and Erase. Its address deltas are added to deltas and events
+ *  unless they are null. */
+template <typename Batch>
+static bool WriteBlockEntries(Batch& batch, const CBlock& block, const CBlockUndo& block_undo, int height, bool disconnect,
+                              BalanceDeltas* deltas, std::vector<AddressDeltaEvent>* events)
+{
+    const auto status{disconnect ? AddressDeltaEvent::DISCONNECTED : AddressDeltaEvent::CONNECTED};
+
+    if (fAddressIndex || fSpentIndex) {
+        if (block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+            return error("%s: block and undo data inconsistent at height %d", __func__, height);
+        }
+
+        // Unspent index entries must be written in the order the block
+        // created and spent them, and in reverse order when undoing it,
+        // because a transaction may spend an output created earlier in the
+        // same block and the batch applies operations in order.
+        for (size_t n = 0; n < block.vtx.size(); ++n) {
+            const size_t i{disconnect ? block.vtx.size() - 1 - n : n};
+            const CTransaction& tx{*block.vtx[i]};
+            const uint256& txhash{tx.GetHash()};
+
+            if (!tx.IsCoinBase()) {
+                const CTxUndo& tx_undo{block_undo.vtxundo[i - 1]};
+                if (tx_undo.vprevout.size() != tx.vin.size()) {
+                    return error("%s: transaction and undo data inconsistent at height %d", __func__, height);
+                }
+                for (size_t j = 0; j < tx.vin.size(); ++j) {
+                    const COutPoint& prevout{tx.vin[j].prevout};
+                    const Coin& coin{tx_undo.vprevout[j]};
+
+                    std::vector<unsigned char> hash_bytes;
+                    int script_type = 0;
+                    if (!ExtractIndexInfo(&coin.out.scriptPubKey, script_type, hash_bytes) || script_type == 0) {
+                        continue;
+                    }
+                    const uint256 address_hash(hash_bytes.data(), hash_bytes.size());
+
+                    if (fAddressIndex) {
+                        // record (or undo) spending activity and remove the
+                        // spent output from the unspent index (or restore it)
+                        const auto address_key{std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(script_type, address_hash, height, i, txhash, j, true))};
+                        const auto unspent_key{std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentKey(script_type, address_hash, prevout.hash, prevout.n))};
+                        if (disconnect) {
+                            batch.Erase(address_key);
+                            batch.Write(unspent_key, CAddressUnspentValue(coin.out.nValue, coin.out.scriptPubKey, coin.nHeight));
+                        } else {
+                            batch.Write(address_key, CAmount{coin.out.nValue * -1});
+                            batch.Erase(unspent_key);
+                        }
+
+                        if (deltas) {
+                            BalanceDelta& delta{(*deltas)[{script_type, address_hash}]};
+                            delta.balance -= coin.out.nValue;
+                            delta.AddTx(txhash);
+                        }
+
+                        if (events) events->emplace_back(status, script_type, address_hash, txhash, j, /*spending_in=*/true, -coin.out.nValue, height);
+                    }
+
+                    if (fSpentIndex) {
+                        // add the spent index to determine the txid and input that spent an output
+                        // and to find the amount and address from an input
+                        const auto spent_key{std::make_pair(DB_SPENTINDEX, CSpentIndexKey(prevout.hash, prevout.n))};
+                        if (disconnect) {
+                            batch.Erase(spent_key);
+                        } else {
+                            batch.Write(spent_key, CSpentIndexValue(txhash, j, height, coin.out.nValue, script_type, address_hash));
+                        }
+                    }
+                }
+            }
+
+            if (fAddressIndex) {
+                for (size_t k = 0; k < tx.vout.size(); ++k) {
+                    const CTxOut& out{tx.vout[k]};
+
+                    std::vector<unsigned char> hash_bytes;
+                    int script_type = 0;
+                    if (!ExtractIndexInfo(&out.scriptPubKey, script_type, hash_bytes) || script_type == 0) {
+                        continue;
+                    }
+                    const uint256 address_hash(hash_bytes.data(), hash_bytes.size());
+
+                    // record (or undo) receiving activity and the unspent output
+                    const auto address_key{std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(script_type, address_hash, height, i, txhash, k, false))};
+                    const auto unspent_key{std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentKey(script_type, address_hash, txhash, k))};
+                    if (disconnect) {
+                        batch.Erase(address_key);
+                        batch.Erase(unspent_key);
+                    } else {
+                        batch.Write(address_key, out.nValue);
+                        batch.Write(unspent_key, CAddressUnspentValue(out.nValue, out.scriptPubKey, height));
+                    }
+
+                    if (deltas) {
+                        BalanceDelta& delta{(*deltas)[{script_type, address_hash}]};
+                        delta.balance += out.nValue;
+                        delta.received += out.nValue;
+                        if (tx.IsCoinBase()) delta.coinbase += out.nValue;
+                        delta.AddTx(txhash);
+                    }
+
+                    if (events) events->emplace_back(status, script_type, address_hash, txhash, k, /*spending_in=*/false, out.nValue, height);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool InsightIndex::WriteBlock(CDBBatch& batch, BalanceCache& balances, const CBlock& block, const CBlockUndo& block_undo, int height, bool disconnect,
+                              std::vector<AddressDeltaEvent>* events)
+{
+    BalanceDeltas deltas;
+    if (!WriteBlockEntries(batch, block, block_undo, height, disconnect, &deltas, events)) {
+        return false;
+    }
+
+    // Fold the block into the per-address balance records. The records are
+    // read through the cache so that a rewind over several blocks sees its
+    // own updates before they are written.
+    for (const auto& [address, delta] : deltas) {
+        auto it{balances.find(address)};
+        if (it == balances.end()) {
+            it = balances.emplace(address, CAddressBalanceValue{}).first;
+            m_db->ReadAddressBalance(address.second, address.first, it->second);
+        }
+        CAddressBalanceValue& value{it->second};
+        auto& recent{value.recentCoinbase};
+        if (disconnect) {
+            value.balance -= delta.balance;
+            value.received -= delta.received;
+            value.txCount -= std::min(value.txCount, delta.tx_count);
+            recent.erase(std::remove_if(recent.begin(), recent.end(), [&](const auto& entry) { return entry.first >= height; }), recent.end());
+            if (value.lastHeight >= height) {
+                value.lastHeight = value.txCount > 0 ? m_db->ReadLastAddressHeight(address.second, address.first, height) : 0;
+            }
+        } else {
+            value.balance += delta.balance;
+            value.received += delta.received;
+            value.txCount += delta.tx_count;
+            value.lastHeight = height;
+            recent.erase(std::remove_if(recent.begin(), recent.end(), [&](const auto& entry) { return entry.first <= height - RECENT_COINBASE_DEPTH; }), recent.end());
+            if (delta.coinbase > 0) recent.emplace_back(height, delta.coinbase);
+        }
+    }
+
+    // Blocks of the active chain are found through m_chain_times, so only
+    // disconnected blocks are kept on disk, for getblockhashes without its
+    // noOrphans option.
+    if (fTimestampIndex && disconnect) {
+        batch.Write(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(block.nTime, block.GetHash())), 0);
+    }
+
+    return true;
+}
+
+void InsightIndex::WriteBalances(CDBBatch& batch, const BalanceCache& balances)
+{
+    for (const auto& [address, value] : balances) {
+        const auto key{std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(address.first, address.second))};
+        if (value.IsNull()) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, value);
+        }
+    }
+}
+
+bool InsightIndex::CustomInit(const std::optional<interfaces::BlockKey>& block)
+{
+    if (fTimestampIndex) {
+        m_chain_times.SetTip(WITH_LOCK(::cs_main, return m_chainstate->m_chain.Tip()));
+    }
+    // Databases written before the best block was recorded with the entries
+    // start out from the locator.
+    interfaces::BlockKey best_block;
+    if (block && !m_db->ReadBestBlock(best_block)) {
+        CDBBatch batch(*m_db);
+        DB::WriteBestBlock(batch, *block);
+        if (!m_db->WriteBatch(batch)) return false;
+    }
+    // Runs of a bulk build that was loaded but not cleaned up.
+    if (block) {
+        try {
+            fs::remove_all(BulkBuildDir());
+        } catch (const fs::filesystem_error& e) {
+            LogPrintf("%s: Failed to remove %s: %s\n", __func__, fs::PathToString(BulkBuildDir()), e.what());
+        }
+    }
+    return true;
+}
+
+bool InsightIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // The genesis block is never connected, so it has no index entries.
+    if (block.height == 0) {
+        CDBBatch batch(*m_db);
+        DB::WriteBestBlock(batch, {block.hash, block.height});
+        return m_db->WriteBatch(batch);
+    }
+
+    assert(block.data);
+    CBlockUndo block_undo;
+    if (fAddressIndex || fSpentIndex) {
+        const CBlockIndex* pindex{WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash))};
+        if (!pindex || !UndoReadFromDisk(block_undo, pindex)) {
+            return error("%s: Failed to read undo data for block %s", __func__, block.hash.ToString());
+        }
+    }
+
+    // All index entries of the block go into a single write, so the indexes
+    // can never be left inconsistent with each other.
+    CDBBatch batch(*m_db);
+    BalanceCache balances;
+    std::vector<AddressDeltaEvent> events;
+    const bool notify{fAddressIndex && g_address_notifier && g_address_notifier->IsWatching()};
+    if (!WriteBlock(batch, balances, *block.data, block_undo, block.height, /*disconnect=*/false, notify ? &events : nullptr)) {
+        return false;
+    }
+    WriteBalances(batch, balances);
+    DB::WriteBestBlock(batch, {block.hash, block.height});
+    if (!m_db->WriteBatch(batch)) return false;
+    if (notify) g_address_notifier->Notify(std::move(events));
+    return true;
+}
+
+bool InsightIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    const CBlockIndex* iter_tip;
+    const CBlockIndex* new_tip_index;
+    {
+        LOCK(cs_main);
+        iter_tip = m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash);
+        new_tip_index = m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash);
+    }
+    const auto& consensus_params{Params().GetConsensus()};
+
+    CDBBatch batch(*m_db);
+    BalanceCache balances;
+    std::vector<AddressDeltaEvent> events;
+    const bool notify{fAddressIndex && g_address_notifier && g_address_notifier->IsWatching()};
+    while (iter_tip != new_tip_index) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, iter_tip, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, iter_tip->GetBlockHash().ToString());
+        }
+        CBlockUndo block_undo;
+        if ((fAddressIndex || fSpentIndex) && !UndoReadFromDisk(block_undo, iter_tip)) {
+            return error("%s: Failed to read undo data for block %s",
+                         __func__, iter_tip->GetBlockHash().ToString());
+        }
+        if (!WriteBlock(batch, balances, block, block_undo, iter_tip->nHeight, /*disconnect=*/true, notify ? &events : nullptr)) {
+            return false;
+        }
+        iter_tip = iter_tip->pprev;
+    }
+    WriteBalances(batch, balances);
+    DB::WriteBestBlock(batch, new_tip);
+
+    if (!m_db->WriteBatch(batch)) return false;
+    if (notify) g_address_notifier->Notify(std::move(events));
+    return true;
+}
+
+namespace {
+/** Collects the entries WriteBlockEntries writes for a range of blocks as the
+ *  records of a sorted run. Records are ordered by height and then in the
+ *  order they were written, so of the records of an unspent output the one
+ *  written last in the chain takes effect. */
+class BulkRecords
+{
+public:
+    std::vector<SortedRecord> records;
+    uint64_t order{0};
+
+    void SetHeight(int height) { order = uint64_t(height) << 32; }
+
+    template <typename K, typename V>
+    void Write(const K& key, const V& value)
+    {
+        SortedRecord& record{records.emplace_back()};
+        CVectorWriter{SER_DISK, CLIENT_VERSION, record.key, 0} << key;
+        CVectorWriter{SER_DISK, CLIENT_VERSION, record.value, 0} << value;
+        record.order = order++;
+    }
+
+    template <typename K>
+    void Erase(const K& key)
+    {
+        SortedRecord& record{records.emplace_back()};
+        CVectorWriter{SER_DISK, CLIENT_VERSION, record.key, 0} << key;
+        record.order = order++;
+        record.erase = true;
+    }
+};
+
+/** What the runs of a bulk build were written for, kept next to them. */
+struct BulkTarget {
+    int version;
+    uint8_t flags;
+    uint256 hash;
+
+    SERIALIZE_METHODS(BulkTarget, obj) { READWRITE(obj.version, obj.flags, obj.hash); }
+};
+} // namespace
+
+static fs::path RunPath(const fs::path& dir, const char* kind, int n)
+{
+    return dir / fs::PathFromString(strprintf("%s%08d.run", kind, n));
+}
+
+bool InsightIndex::CustomBulkSync(const CBlockIndex*& pindex)
+{
+    const int64_t min_height{gArgs.GetIntArg("-indexbulkheight", DEFAULT_INDEX_BULK_HEIGHT)};
+    const CBlockIndex* target{WITH_LOCK(::cs_main, return m_chainstate->m_chain.Tip())};
+    if (min_height <= 0 || !target || target->nHeight < min_height) return true;
+
+    // Only the address and spent indexes have entries for blocks of the
+    // active chain, so without them there is nothing to scan.
+    if (!fAddressIndex && !fSpentIndex) {
+        CDBBatch batch(*m_db);
+        DB::WriteBestBlock(batch, {target->GetBlockHash(), target->nHeight});
+        if (!m_db->WriteBatch(batch)) return false;
+        pindex = target;
+        return true;
+    }
+
+    // The runs of an interrupted bulk build are used again if they were
+    // written for the same indexes up to a block still in the active chain.
+    const fs::path dir{BulkBuildDir()};
+    const fs::path target_path{dir / "target.dat"};
+    BulkTarget state{INDEX_VERSION, EnabledIndexFlags(), target->GetBlockHash()};
+    bool resume{false};
+    try {
+        AutoFile file{fsbridge::fopen(target_path, "rb")};
+        if (!file.IsNull()) {
+            BulkTarget prev;
+            file >> prev;
+            LOCK(::cs_main);
+            const CBlockIndex* prev_target{m_chainstate->m_blockman.LookupBlockIndex(prev.hash)};
+            if (prev.version == state.version && prev.flags == state.flags && prev_target && m_chainstate->m_chain.Contains(prev_target)) {
+                target = prev_target;
+                resume = true;
+            }
+        }
+    } catch (const std::ios_base::failure&) {
+    }
+    try {
+        if (!resume) {
+            fs::remove_all(dir);
+            TryCreateDirectories(dir);
+            AutoFile file{fsbridge::fopen(target_path, "wb")};
+            file << state;
+            if (!FileCommit(file.Get())) {
+                return error("%s: Failed to write %s", __func__, fs::PathToString(target_path));
+            }
+        }
+    } catch (const std::exception& e) {
+        return error("%s: Failed to set up %s: %s", __func__, fs::PathToString(dir), e.what());
+    }
+    LogPrintf("%s %s in bulk up to height %d\n", resume ? "Resuming to build" : "Building", GetName(), target->nHeight);
+
+    // Keep the blocks from being pruned while they are scanned.
+    node::PruneLockInfo prune_lock;
+    prune_lock.height_first = 0;
+    WITH_LOCK(::cs_main, m_chainstate->m_blockman.UpdatePruneLock(GetName(), prune_lock));
+
+    if (!BulkScan(dir, *target) || !BulkLoad(dir, *target)) {
+        // The runs written so far are used again on the next start.
+        return IsInterrupted();
+    }
+
+    try {
+        fs::remove_all(dir);
+    } catch (const fs::filesystem_error& e) {
+        LogPrintf("%s: Failed to remove %s: %s\n", __func__, fs::PathToString(dir), e.what());
+    }
+    pindex = target;
+    return true;
+}
+
+bool InsightIndex::BulkScan(const fs::path& dir, const CBlockIndex& target)
+{
+    // Find the blocks the runs of an earlier attempt already hold.
+    std::vector<bool> done(target.nHeight + 1);
+    try {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() == ".tmp") {
+                fs::remove(entry.path());
+            } else if (entry.path().extension() == ".run") {
+                const SortedRunReader run{entry.path()};
+                for (const auto& [first, last] : run.Ranges()) {
+                    for (int height = std::max(first, 0); height <= std::min(last, target.nHeight); ++height) {
+                        done[height] = true;
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        return error("%s: Failed to read the runs in %s: %s", __func__, fs::PathToString(dir), e.what());
+    }
+
+    // The scan gets threads of its own, as many as serve the readers, so it
+    // does not hold up address queries for the length of the build.
+    IndexReadPool scan_pool;
+    scan_pool.Start(g_index_read_pool.ThreadCount(), "idxbulk", SyscallSandboxPolicy::TX_INDEX);
+
+    // Split the remaining blocks into ranges whose records fit the share of
+    // the memory of one scanning thread.
+    const size_t range_txs{std::max<size_t>(m_bulk_memory / (scan_pool.ThreadCount() + 1) / BULK_BYTES_PER_TX, 1)};
+    HeightRanges ranges;
+    int blocks{0};
+    {
+        LOCK(::cs_main);
+        int first{0}, last{0};
+        size_t txs{0};
+        const auto close{[&] {
+            if (last > 0) ranges.emplace_back(first, last);
+            last = 0;
+            txs = 0;
+        }};
+        for (const CBlockIndex* block{&target}; block->nHeight > 0; block = block->pprev) {
+            if (done[block->nHeight]) {
+                close();
+                continue;
+            }
+            if (last == 0) last = block->nHeight;
+            first = block->nHeight;
+            txs += block->nTx;
+            ++blocks;
+            if (txs >= range_txs) close();
+        }
+        close();
+    }
+    std::reverse(ranges.begin(), ranges.end());
+    if (ranges.empty()) return true;
+    LogPrintf("Scanning %d blocks for %s in %u ranges\n", blocks, GetName(), ranges.size());
+
+    const auto& consensus_params{Params().GetConsensus()};
+    std::atomic<int> scanned{0};
+    Mutex log_mutex;
+    auto last_log{std::chrono::steady_clock::now()};
+    return scan_pool.Run(ranges.size(), [&](size_t pos) {
+        const auto [first, last]{ranges[pos]};
+        std::vector<const CBlockIndex*> range;
+        for (const CBlockIndex* block{target.GetAncestor(last)}; block->nHeight >= first; block = block->pprev) {
+            range.push_back(block);
+        }
+
+        BulkRecords records;
+        for (auto it{range.rbegin()}; it != range.rend(); ++it) {
+            if (IsInterrupted()) return false;
+            const CBlockIndex* block{*it};
+            CBlock data;
+            CBlockUndo block_undo;
+            if (!ReadBlockFromDisk(data, block, consensus_params) || !UndoReadFromDisk(block_undo, block)) {
+                return error("%s: Failed to read block %s from disk", __func__, block->GetBlockHash().ToString());
+            }
+            records.SetHeight(block->nHeight);
+            if (!WriteBlockEntries(records, data, block_undo, block->nHeight, /*disconnect=*/false, /*deltas=*/nullptr, /*events=*/nullptr)) {
+                return false;
+            }
+        }
+        try {
+            if (!WriteSortedRun(RunPath(dir, "blocks", first), {{first, last}}, records.records)) return false;
+        } catch (const std::ios_base::failure& e) {
+            return error("%s: Failed to write a sorted run: %s", __func__, e.what());
+        }
+
+        const int count{scanned += last - first + 1};
+        const auto now{std::chrono::steady_clock::now()};
+        LOCK(log_mutex);
+        if (now - last_log > BULK_LOG_INTERVAL) {
+            LogPrintf("Building %s in bulk: scanned %d of %d blocks\n", GetName(), count, blocks);
+            last_log = now;
+        }
+        return true;
+    });
+}
+
+bool InsightIndex::BulkLoad(const fs::path& dir, const CBlockIndex& target)
+{
+    try {
+        std::vector<fs::path> paths;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() == ".run") paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+
+        const auto open{[](std::vector<fs::path>::const_iterator begin, std::vector<fs::path>::const_iterator end, HeightRanges& ranges) {
+            std::vector<std::unique_ptr<SortedRunReader>> runs;
+            for (auto it{begin}; it != end; ++it) {
+                const auto& run{runs.emplace_back(std::make_unique<SortedRunReader>(*it))};
+                ranges.insert(ranges.end(), run->Ranges().begin(), run->Ranges().end());
+            }
+            return runs;
+        }};
+
+        // Merge the first runs into larger ones until few enough are left to
+        // be merged into the database at once.
+        while (paths.size() > MAX_BULK_MERGE_RUNS) {
+            const auto group_end{paths.begin() + MAX_BULK_MERGE_RUNS};
+            HeightRanges ranges;
+            auto runs{open(paths.begin(), group_end, ranges)};
+            int n{0};
+            while (fs::exists(RunPath(dir, "merged", n))) ++n;
+            const fs::path merged{RunPath(dir, "merged", n)};
+            SortedRunWriter writer{merged, ranges};
+            if (!MergeSortedRuns(runs, [&](SortedRecord& record) {
+                    writer.Write(record);
+                    return !IsInterrupted();
+                }) || !writer.Commit()) {
+                return false;
+            }
+            runs.clear();
+            for (auto it{paths.begin()}; it != group_end; ++it) {
+                fs::remove(*it);
+            }
+            paths.erase(paths.begin(), group_end);
+            paths.push_back(merged);
+        }
+
+        HeightRanges ranges;
+        const auto runs{open(paths.begin(), paths.end(), ranges)};
+        LogPrintf("Loading %s from %u sorted runs\n", GetName(), runs.size());
+        if (!m_db->WriteIndexVersion(INDEX_VERSION_BULK_LOADING)) return false;
+
+        // The balance records are folded from the address index entries,
+        // which come out of the merge grouped by address in height order.
+        BalanceFolder balances;
+        CDBBatch batch(*m_db);
+
+        uint64_t count{0};
+        auto last_log{std::chrono::steady_clock::now()};
+        if (!MergeSortedRuns(runs, [&](SortedRecord& record) {
+                // Unspent outputs whose last record spends them are not written.
+                if (record.erase) return true;
+                if (record.key[0] == DB_ADDRESSINDEX) {
+                    std::pair<uint8_t, CAddressIndexKey> key;
+                    CAmount amount;
+                    SpanReader{SER_DISK, CLIENT_VERSION, record.key} >> key;
+                    SpanReader{SER_DISK, CLIENT_VERSION, record.value} >> amount;
+                    balances.Add(batch, key.second, amount);
+                }
+                batch.Write(Span<const unsigned char>{record.key}, Span<const unsigned char>{record.value});
+                ++count;
+
+                if (batch.SizeEstimate() > BULK_BATCH_SIZE) {
+                    if (IsInterrupted() || !m_db->WriteBatch(batch)) return false;
+                    batch.Clear();
+                    const auto now{std::chrono::steady_clock::now()};
+                    if (now - last_log > BULK_LOG_INTERVAL) {
+                        LogPrintf("Loading %s: %u entries\n", GetName(), count);
+                        last_log = now;
+                    }
+                }
+                return true;
+            })) {
+            return false;
+        }
+        balances.Finish(batch);
+
+        // The best block and the locator go into the last batch, so the
+        // index never syncs block by block on top of a partly loaded one.
+        DB::WriteBestBlock(batch, {target.GetBlockHash(), target.nHeight});
+        m_db->BaseIndex::DB::WriteBestBlock(batch, GetLocator(&target));
+        batch.Write(DB_INDEX_VERSION, INDEX_VERSION);
+        if (!m_db->WriteBatch(batch, /*fSync=*/true)) return false;
+        LogPrintf("Loaded %u %s entries up to height %d\n", count, GetName(), target.nHeight);
+    } catch (const std::exception& e) {
+        return error("%s: Failed to merge the runs in %s: %s", __func__, fs::PathToString(dir), e.what());
+    }
+    return true;
+}
+
+bool InsightIndex::MigrateLegacyEntries(CBlockTreeDB& block_tree_db, const CBlockIndex* tip)
+{
+    if (!HasLegacyInsightEntries(block_tree_db)) return true;
+
+    interfaces::BlockKey best_block;
+    if (!tip || m_db->ReadBestBlock(best_block)) return EraseLegacyInsightEntries(block_tree_db);
+    // The flag of an index was only set on a new block index database, so
+    // its entries cover all blocks.
+    bool address{false}, spent{false}, timestamp{false};
+    block_tree_db.ReadFlag("addressindex", address);
+    block_tree_db.ReadFlag("spentindex", spent);
+    block_tree_db.ReadFlag("timestampindex", timestamp);
+    if ((fAddressIndex && !address) || (fSpentIndex && !spent) || (fTimestampIndex && !timestamp)) {
+        LogPrintf("%s: The block index database lacks entries of the enabled indexes, rebuilding %s\n", __func__, GetName());
+        return EraseLegacyInsightEntries(block_tree_db);
+    }
+
+    LogPrintf("Migrating the index entries of the block index database to %s\n", GetName());
+    // Left marked as migrating if interrupted, so it is rebuilt on the next
+    // start. The entries left in blocks/index are erased then.
+    if (!m_db->WriteIndexVersion(INDEX_VERSION_MIGRATING)) return false;
+    uint64_t count{0};
+    if (!MoveLegacyInsightEntries(block_tree_db, m_db.get(), count)) return false;
+
+    // The balance records are folded from the migrated address index entries,
+    // which are in height order in the current encoding.
+    CDBBatch batch(*m_db);
+    if (fAddressIndex) {
+        BalanceFolder balances;
+        std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+        for (pcursor->Seek(DB_ADDRESSINDEX); pcursor->Valid(); pcursor->Next()) {
+            if (ShutdownRequested()) return false;
+            std::pair<uint8_t, CAddressIndexKey> key;
+            CAmount amount;
+            if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX) break;
+            if (!pcursor->GetValue(amount)) {
+                return error("%s: failed to read address index entry", __func__);
+            }
+            balances.Add(batch, key.second, amount);
+            if (batch.SizeEstimate() > BULK_BATCH_SIZE) {
+                if (!m_db->WriteBatch(batch)) return false;
+                batch.Clear();
+            }
+        }
+        balances.Finish(batch);
+    }
+
+    // Earlier versions wrote the entries of a block as it was connected, so
+    // they are up to date with the tip.
+    DB::WriteBestBlock(batch, {tip->GetBlockHash(), tip->nHeight});
+    m_db->BaseIndex::DB::WriteBestBlock(batch, GetLocator(tip));
+    batch.Write(DB_INDEX_VERSION, INDEX_VERSION);
+    if (!m_db->WriteBatch(batch, /*fSync=*/true)) return false;
+    LogPrintf("Migrated %u index entries to %s up to height %d\n", count, GetName(), tip->nHeight);
+    return true;
+}
+
+void InsightIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    BaseIndex::BlockConnected(block, pindex);
+    if (fTimestampIndex) m_chain_times.SetTip(pindex);
+}
+
+void InsightIndex::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    if (fTimestampIndex) m_chain_times.SetTip(pindex->pprev);
+    RewindDisconnectedBlock(pindex);
+}
+
+BaseIndex::DB& InsightIndex::GetDB() const { return *m_db; }
+
+std::unique_ptr<CDBSnapshot> InsightIndex::TakeSnapshot() const
+{
+    return std::make_unique<CDBSnapshot>(*m_db);
+}
+
+bool InsightIndex::ReadBestBlock(interfaces::BlockKey& block, const CDBSnapshot* snapshot) const
+{
+    return m_db->ReadBestBlock(block, snapshot);
+}
+
+bool InsightIndex::ReadBatch(const CDBSnapshot& snapshot, size_t count, const std::function<bool(size_t pos, const CDBSnapshot& snapshot)>& read) const
+{
+    return g_index_read_pool.Run(count, [&](size_t pos) { return read(pos, snapshot); });
+}
+
+bool InsightIndex::ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    return m_db->ReadSpentIndex(key, value);
+}
+
+bool InsightIndex::ReadAddressIndex(const uint256& address_hash, int type,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount>>& address_index,
+                                    int start, int end) const
+{
+    return m_db->ScanAddressIndex(address_hash, type, /*after=*/nullptr, start, end,
+                                  [&](const CAddressIndexKey& key, CAmount value) {
+                                      address_index.emplace_back(key, value);
+                                      return true;
+                                  }, /*snapshot=*/nullptr);
+}
+
+bool InsightIndex::ScanAddressIndex(const uint256& address_hash, int type, const CAddressIndexKey* after,
+                                    int start, int end,
+                                    const std::function<bool(const CAddressIndexKey&, CAmount)>& visit,
+                                    const CDBSnapshot* snapshot) const
+{
+    return m_db->ScanAddressIndex(address_hash, type, after, start, end, visit, snapshot);
+}
+
+bool InsightIndex::ReadAddressUnspentIndex(const uint256& address_hash, int type,
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& unspent_outputs) const
+{
+    return m_db->ScanAddressUnspentIndex(address_hash, type, /*after=*/nullptr,
+                                         [&](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
+                                             unspent_outputs.emplace_back(key, value);
+                                             return true;
+                                         }, /*snapshot=*/nullptr);
+}
+
+bool InsightIndex::ScanAddressUnspentIndex(const uint256& address_hash, int type, const CAddressUnspentKey* after,
+                                           const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& visit,
+                                           const CDBSnapshot* snapshot) const
+{
+    return m_db->ScanAddressUnspentIndex(address_hash, type, after, visit, snapshot);
+}
+
+bool InsightIndex::ReadAddressBalance(const uint256& address_hash, int type, CAddressBalanceValue& balance,
+                                      const CDBSnapshot* snapshot) const
+{
+    return m_db->ReadAddressBalance(address_hash, type, balance, snapshot);
+}
+
+bool InsightIndex::ReadTimestampIndex(unsigned int high, unsigned int low, bool active_only, std::vector<std::pair<uint256, unsigned int>>& hashes) const
+{
+    const size_t first{hashes.size()};
+    m_chain_times.FindBlocks(high, low, hashes);
+
+    if (!active_only) {
+        // Databases written before the active chain was kept in memory, and
+        // blocks that were reconnected, also have entries for active blocks.
+        const std::set<uint256> active{[&] {
+            std::set<uint256> set;
+            for (auto it = hashes.begin() + first; it != hashes.end(); ++it) set.insert(it->first);
+            return set;
+        }()};
+        std::vector<std::pair<uint256, unsigned int>> stale;
+        if (!m_db->ReadTimestampIndex(high, low, stale)) return false;
+        for (const auto& entry : stale) {
+            if (!active.count(entry.first)) hashes.push_back(entry);
+        }
+    }
+
+    std::sort(hashes.begin() + first, hashes.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.second, a.first) < std::tie(b.second, b.first);
+    });
+    return true;
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_INSIGHTINDEX_H
+#define BITCOIN_INDEX_INSIGHTINDEX_H
+
+#include <consensus/amount.h>
+#include <dbwrapper.h>
+#include <index/base.h>
+#include <spentindex.h>
+#include <sync.h>
+#include <util/fs.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct AddressDeltaEvent;
+class CBlockIndex;
+class CBlockTreeDB;
+class CBlockUndo;
+
+static constexpr int64_t MAX_INSIGHT_INDEX_CACHE{1024};
+/** Maximum number of dedicated index reader threads allowed */
+static constexpr int MAX_INDEX_READ_THREADS{15};
+/** -indexreadthreads default (number of index reader threads, 0 = auto) */
+static constexpr int DEFAULT_INDEX_READ_THREADS{0};
+/** -indexbulkheight default (chain height from which an empty index is built in bulk, 0 = never) */
+static constexpr int DEFAULT_INDEX_BULK_HEIGHT{10000};
+
+/**
+ * The blocks of the active chain by height, kept apart from CChain so that
+ * timestamp queries over the active chain need neither the database nor
+ * cs_main. Block times are not monotonic along the chain but
+ * CBlockIndex::nTimeMax is, so the start of a time range is found by binary
+ * search.
+ */
+class ActiveChainTimes
+{
+private:
+    mutable Mutex m_mutex;
+    std::vector<const CBlockIndex*> m_chain GUARDED_BY(m_mutex);
+
+public:
+    /// Make pindex the tip, replacing the blocks that are not its ancestors.
+    void SetTip(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /// Append the hashes and times of the blocks with low <= time < high,
+    /// in height order. The genesis block is not included.
+    void FindBlocks(unsigned int high, unsigned int low, std::vector<std::pair<uint256, unsigned int>>& blocks) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+/**
+ * InsightIndex maintains the address, address unspent, spent and timestamp
+ * indexes used by the explorer RPCs in rpc/index.cpp. Which of them are kept
+ * follows -addressindex, -spentindex and -timestampindex.
+ *
+ * Like the other indexes it is written from the validation interface queue
+ * into its own LevelDB database (indexes/insight/), so connecting a block does
+ * not wait on index I/O. Blocks disconnected from the active chain are undone
+ * as soon as the notification arrives, so the index never serves entries of a
+ * stale block for longer than the queue lags behind.
+ *
+ * An empty index on a chain of at least -indexbulkheight blocks is built in
+ * bulk instead: the block files are scanned in parallel into sorted runs
+ * (indexes/insight_bulk/), which are merged into the database in key order.
+ * The runs survive a restart, so an interrupted bulk build resumes.
+ */
+class InsightIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    std::unique_ptr<DB> m_db;
+
+    /// Active chain blocks for the timestamp index, which keeps only the
+    /// blocks disconnected from the active chain on disk.
+    ActiveChainTimes m_chain_times;
+
+    bool AllowPrune() const override { return true; }
+
+    /// Memory the records of the blocks scanned at once may take in a bulk
+    /// build, shared by the index reader threads.
+    const size_t m_bulk_memory;
+
+    /** Address balance records touched by the blocks of one batch. */
+    using BalanceCache = std::map<std::pair<unsigned int, uint256>, CAddressBalanceValue>;
+
+    /** Add (or with disconnect set, remove) the index entries of one block to
+     *  a batch, and its address deltas to events unless that is null. */
+    bool WriteBlock(CDBBatch& batch, BalanceCache& balances, const CBlock& block, const CBlockUndo& block_undo, int height, bool disconnect,
+                    std::vector<AddressDeltaEvent>* events);
+
+    static void WriteBalances(CDBBatch& batch, const BalanceCache& balances);
+
+    /** Write the entries of the blocks up to target that are not in a run in
+     *  dir yet to sorted runs, scanning ranges of blocks in parallel. */
+    bool BulkScan(const fs::path& dir, const CBlockIndex& target);
+    /** Merge the runs in dir into the database, together with the address
+     *  balance records folded from them and target as the best block. */
+    bool BulkLoad(const fs::path& dir, const CBlockIndex& target);
+
+protected:
+    bool CustomInit(const std::optional<interfaces::BlockKey>& block) override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomBulkSync(const CBlockIndex*& pindex) override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried. The
+    /// database is wiped if it was built with a different set of -addressindex,
+    /// -spentindex and -timestampindex.
+    explicit InsightIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~InsightIndex() override;
+
+    /// Move the entries that earlier versions kept in blocks/index into the
+    /// index, which must not be started yet, with tip as its best block. They
+    /// are only erased if the index is not empty or they do not cover all of
+    /// the enabled indexes, and the index is built from the blocks instead.
+    bool MigrateLegacyEntries(CBlockTreeDB& block_tree_db, const CBlockIndex* tip);
+
+    /// Take a view of the index that the reads below can be given, so that
+    /// several of them see the same state even while blocks are indexed.
+    std::unique_ptr<CDBSnapshot> TakeSnapshot() const;
+    /// Read the block that the index, or the snapshot of it, is up to date
+    /// with. It is written in the same batch as the entries of the block, so
+    /// reads against one snapshot always agree with it.
+    bool ReadBestBlock(interfaces::BlockKey& block, const CDBSnapshot* snapshot = nullptr) const;
+    /// Call read(pos, snapshot) for every pos below count, spread over the
+    /// -indexreadthreads pool and the calling thread. read must not throw and
+    /// may only write to the results of its own position. Returns false if
+    /// any call returned false.
+    bool ReadBatch(const CDBSnapshot& snapshot, size_t count, const std::function<bool(size_t pos, const CDBSnapshot& snapshot)>& read) const;
+
+    bool ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+    bool ReadAddressIndex(const uint256& address_hash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount>>& address_index,
+                          int start = 0, int end = 0) const;
+    bool ReadAddressUnspentIndex(const uint256& address_hash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& unspent_outputs) const;
+
+    /// Visit the address index entries of an address in key order without
+    /// collecting them, resuming after the key `after` if it is not null.
+    /// Iteration stops early when `visit` returns false.
+    bool ScanAddressIndex(const uint256& address_hash, int type, const CAddressIndexKey* after, int start, int end,
+                          const std::function<bool(const CAddressIndexKey&, CAmount)>& visit,
+                          const CDBSnapshot* snapshot = nullptr) const;
+    /// Like ScanAddressIndex, for the unspent outputs of an address.
+    bool ScanAddressUnspentIndex(const uint256& address_hash, int type, const CAddressUnspentKey* after,
+                                 const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& visit,
+                                 const CDBSnapshot* snapshot = nullptr) const;
+    /// Read the aggregated balance record of an address. Returns false if the
+    /// address has no confirmed activity.
+    bool ReadAddressBalance(const uint256& address_hash, int type, CAddressBalanceValue& balance,
+                            const CDBSnapshot* snapshot = nullptr) const;
+    /// Read the blocks with low <= time < high, ordered by time. Blocks of the
+    /// active chain are found in memory; unless active_only is set, blocks
+    /// that were disconnected from it are read from the database.
+    bool ReadTimestampIndex(unsigned int high, unsigned int low, bool active_only, std::vector<std::pair<uint256, unsigned int>>& hashes) const;
+};
+
+/// The global address/spent/timestamp index, used by the explorer RPCs. May be null.
+extern std::unique_ptr<InsightIndex> g_insightindex;
+
+/** Erase the entries that earlier versions kept in blocks/index, which are
+ *  not needed when the indexes are disabled. */
+bool EraseLegacyInsightEntries(CBlockTreeDB& block_tree_db);
+
+/** Run instances of index reader threads for InsightIndex::ReadBatch. A bulk
+ *  build scans blocks on as many threads of its own. */
+void StartIndexReadWorkerThreads(int threads_num);
+/** Stop all of the index reader threads */
+void StopIndexReadWorkerThreads();
+
+#endif // BITCOIN_INDEX_INSIGHTINDEX_H
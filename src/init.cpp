@@ -13,18 +13,21 @@
 #include <kernel/mempool_persist.h>
 #include <kernel/validation_cache_sizes.h>
 
+#include <addressnotifier.h>
 #include <addrman.h>
 #include <banman.h>
 #include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/amount.h>
+#include <crypto/yespower.h>
 #include <deploymentstatus.h>
 #include <hash.h>
 #include <httprpc.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/insightindex.h>
 #include <index/txindex.h>
 #include <init/common.h>
 #include <interfaces/chain.h>
@@ -220,6 +223,9 @@ void Interrupt(NodeContext& node)
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    if (g_insightindex) {
+        g_insightindex->Interrupt();
+    }
     ForEachBlockFilterIndex([](BlockFilterIndex& index) { index.Interrupt(); });
     if (g_coin_stats_index) {
         g_coin_stats_index->Interrupt();
@@ -262,6 +268,8 @@ void Shutdown(NodeContext& node)
     if (node.scheduler) node.scheduler->stop();
     if (node.chainman && node.chainman->m_load_block.joinable()) node.chainman->m_load_block.join();
     StopScriptCheckWorkerThreads();
+    StopPoWCheckWorkerThreads();
+    StopIndexReadWorkerThreads();
 
     // After the threads that potentially access these pointers have been stopped,
     // destruct and reset all to nullptr.
@@ -297,6 +305,10 @@ void Shutdown(NodeContext& node)
         g_txindex->Stop();
         g_txindex.reset();
     }
+    if (g_insightindex) {
+        g_insightindex->Stop();
+        g_insightindex.reset();
+    }
     if (g_coin_stats_index) {
         g_coin_stats_index->Stop();
         g_coin_stats_index.reset();
@@ -330,6 +342,7 @@ void Shutdown(NodeContext& node)
         g_zmq_notification_interface = nullptr;
     }
 #endif
+    g_address_notifier.reset();
 
     node.chain_clients.clear();
     UnregisterAllValidationInterfaces();
@@ -425,12 +438,16 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-version", "Print version and exit", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
     argsman.AddArg("-addressindex", strprintf("Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)", DEFAULT_ADDRESSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-indexbulkheight=<n>", strprintf("Build an empty address or spent index in bulk from sorted runs of the entries of all blocks if the chain is at least <n> blocks high, rather than block by block (0 = never, default: %d)", DEFAULT_INDEX_BULK_HEIGHT), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-indexreadthreads=<n>", strprintf("Set the number of threads used to read the address index for queries of several addresses, and to scan blocks in a bulk build of the address or spent index (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
+        -GetNumCores(), MAX_INDEX_READ_THREADS, DEFAULT_INDEX_READ_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-spentindex", strprintf("Maintain a full spent index, used to query the spending txid and input index for an outpoint (default: %u)", DEFAULT_SPENTINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-timestampindex", strprintf("Maintain a timestamp index for block hashes, used to query blocks hashes by a range of timestamps (default: %u)", DEFAULT_TIMESTAMPINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #if HAVE_SYSTEM
     argsman.AddArg("-alertnotify=<cmd>", "Execute command when an alert is raised (%s in cmd is replaced by message)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     argsman.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s, signet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex(), signetChainParams->GetConsensus().defaultAssumeValid.GetHex()), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockprefetch=<n>", strprintf("Read up to <n> blocks ahead on helper threads when connecting blocks from disk (e.g. in -reindex and -reindex-chainstate) and when building indexes (0 = off, max: %d, default: %d)", MAX_BLOCK_PREFETCH, DEFAULT_BLOCK_PREFETCH), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS); /* YespowerSugar */
     argsman.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-fastprune", "Use smaller block files and lower minimum prune height for testing purposes", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
 #if HAVE_SYSTEM
@@ -441,6 +458,7 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-coinstatsindex", strprintf("Maintain coinstats index used by the gettxoutsetinfo RPC (default: %u)", DEFAULT_COINSTATSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-conf=<file>", strprintf("Specify path to read-only configuration file. Relative paths will be prefixed by datadir location (only useable from command line, not configuration file) (default: %s)", BITCOIN_CONF_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-datadir=<dir>", "Specify data directory", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxmappedblockfiles=<n>", strprintf("Keep up to <n> block and undo files memory mapped for reading blocks and undo data (0 = read them through file streams, default: %u)", kernel::DEFAULT_MAX_MAPPED_BLOCK_FILES), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS); /* YespowerSugar */
     argsman.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbcache=<n>", strprintf("Maximum database cache size <n> MiB (%d to %d, default: %d). In addition, unused mempool memory is shared for this cache (see -maxmempool).", nMinDbCache, nMaxDbCache, nDefaultDbCache), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-includeconf=<file>", "Specify additional configuration file, relative to the -datadir path (only useable from configuration file, not command line)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -452,6 +470,9 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-par=<n>", strprintf("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool", strprintf("Whether to save the mempool on shutdown and load on restart (default: %u)", DEFAULT_PERSIST_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxpowmem=<n>", strprintf("Maximum memory used for proof-of-work scratch buffers in MiB. At least one buffer is always kept, whatever the limit (default: %u)", DEFAULT_MAX_POW_MEMORY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-powthreads=<n>", strprintf("Set the number of threads used to verify proof-of-work of received header batches (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
+        -GetNumCores(), MAX_POWCHECK_THREADS, DEFAULT_POWCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-pid=<file>", strprintf("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)", BITCOIN_PID_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
@@ -536,26 +557,31 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-zmqpubrawblock=<address>", "Enable publish raw block in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequence=<address>", "Enable publish hash block and tx sequence in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubaddressdelta=<address>", "Enable publish deltas of watched addresses in <address> (requires -addressindex)", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashblockhwm=<n>", strprintf("Set publish hash block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashtxhwm=<n>", strprintf("Set publish hash transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish hash sequence message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubaddressdeltahwm=<n>", strprintf("Set publish address delta outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
     hidden_args.emplace_back("-zmqpubrawblock=<address>");
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
     hidden_args.emplace_back("-zmqpubsequence=<n>");
+    hidden_args.emplace_back("-zmqpubaddressdelta=<address>");
     hidden_args.emplace_back("-zmqpubhashblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubhashtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqpubaddressdeltahwm=<n>");
 #endif
 
     argsman.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checklevel=<n>", strprintf("How thorough the block verification of -checkblocks is: %s (0-4, default: %u)", Join(CHECKLEVEL_DOC, ", "), DEFAULT_CHECKLEVEL), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-checkblockreadpow", strprintf("Recompute the proof of work of every block read from disk, instead of matching it against the block index (default: %u)", node::DEFAULT_CHECK_BLOCK_READ_POW), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST); /* YespowerSugar */
     argsman.AddArg("-checkblockindex", strprintf("Do a consistency check for the block tree, chainstate, and other validation data structures occasionally. (default: %u, regtest: %u)", defaultChainParams->DefaultConsistencyChecks(), regtestChainParams->DefaultConsistencyChecks()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkaddrman=<n>", strprintf("Run addrman consistency checks every <n> operations. Use 0 to disable. (default: %u)", DEFAULT_ADDRMAN_CONSISTENCY_CHECKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkmempool=<n>", strprintf("Run mempool consistency checks every <n> transactions. Use 0 to disable. (default: %u, regtest: %u)", defaultChainParams->DefaultConsistencyChecks(), regtestChainParams->DefaultConsistencyChecks()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -907,18 +933,6 @@ bool AppInitParameterInteraction(const ArgsManager& args, bool use_syscall_sandb
         }
     }
 
-    // Make sure additional indexes are recalculated correctly in VerifyDB
-    // (we must reconnect blocks whenever we disconnect them for these indexes to work)
-    bool fAdditionalIndexes =
-        args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ||
-        args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
-        args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-
-    if (fAdditionalIndexes && args.GetIntArg("-checklevel", DEFAULT_CHECKLEVEL) < 4) {
-        gArgs.ForceSetArg("-checklevel", "4");
-        LogPrintf("%s: parameter interaction: additional indexes -> setting -checklevel=4\n", __func__);
-    }
-
     // If -forcednsseed is set to true, ensure -dnsseed has not been set to false
     if (args.GetBoolArg("-forcednsseed", DEFAULT_FORCEDNSSEED) && !args.GetBoolArg("-dnsseed", DEFAULT_DNSSEED)){
         return InitError(_("Cannot set -forcednsseed to true when setting -dnsseed to false."));
@@ -1006,6 +1020,11 @@ bool AppInitParameterInteraction(const ArgsManager& args, bool use_syscall_sandb
         if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
             return InitError(_("-reindex-chainstate option is not compatible with -txindex. Please temporarily disable txindex while using -reindex-chainstate, or replace -reindex-chainstate with -reindex to fully rebuild all indexes."));
         }
+        if (args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ||
+            args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
+            args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX)) {
+            return InitError(_("-reindex-chainstate option is not compatible with -addressindex, -spentindex or -timestampindex. Please temporarily disable them while using -reindex-chainstate, or replace -reindex-chainstate with -reindex to fully rebuild all indexes."));
+        }
     }
 
 #if defined(USE_SYSCALL_SANDBOX)
@@ -1162,6 +1181,24 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         StartScriptCheckWorkerThreads(script_threads);
     }
 
+    /* YespowerSugar */
+    int pow_threads = args.GetIntArg("-powthreads", DEFAULT_POWCHECK_THREADS);
+    if (pow_threads <= 0) {
+        // -powthreads=0 means autodetect, -powthreads=-n means "leave n cores free"
+        pow_threads += GetNumCores();
+    }
+
+    // Subtract 1 because the message handler thread takes part in each batch
+    pow_threads = std::min(std::max(pow_threads - 1, 0), MAX_POWCHECK_THREADS);
+
+    LogPrintf("Header proof-of-work verification uses %d additional threads\n", pow_threads);
+    const int64_t max_pow_memory{std::max<int64_t>(args.GetIntArg("-maxpowmem", DEFAULT_MAX_POW_MEMORY), 0)};
+    GetYespowerContextPool().SetMaxBytes(static_cast<size_t>(max_pow_memory) << 20);
+    LogPrintf("Proof-of-work scratch memory is limited to %d MiB\n", max_pow_memory);
+    if (pow_threads >= 1) {
+        StartPoWCheckWorkerThreads(pow_threads);
+    }
+
     assert(!node.scheduler);
     node.scheduler = std::make_unique<CScheduler>();
 
@@ -1446,6 +1483,7 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     // ********************************************************* Step 7: load block chain
 
     fReindex = args.GetBoolArg("-reindex", false);
+    node::g_check_block_read_pow = args.GetBoolArg("-checkblockreadpow", node::DEFAULT_CHECK_BLOCK_READ_POW); /* YespowerSugar */
     bool fReindexChainState = args.GetBoolArg("-reindex-chainstate", false);
     ChainstateManager::Options chainman_opts{
         .chainparams = chainparams,
@@ -1465,6 +1503,9 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1f MiB for transaction index database\n", cache_sizes.tx_index * (1.0 / 1024 / 1024));
     }
+    if (cache_sizes.insight_index > 0) {
+        LogPrintf("* Using %.1f MiB for address/spent/timestamp index database\n", cache_sizes.insight_index * (1.0 / 1024 / 1024));
+    }
     for (BlockFilterType filter_type : g_enabled_filter_types) {
         LogPrintf("* Using %.1f MiB for %s block filter index database\n",
                   cache_sizes.filter_index * (1.0 / 1024 / 1024), BlockFilterTypeName(filter_type));
@@ -1510,10 +1551,6 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
                 "", CClientUIInterface::MSG_ERROR);
         };
 
-        options.addressindex = args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-        options.spentindex = args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-        options.timestampindex = args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-
         uiInterface.InitMessage(_("Loading block index…").translated);
         const auto load_block_index_start_time{SteadyClock::now()};
         auto catch_exceptions = [](auto&& f) {
@@ -1589,6 +1626,38 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         }
     }
 
+    fAddressIndex = args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
+    fSpentIndex = args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
+    fTimestampIndex = args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
+    if (fAddressIndex) {
+        g_address_notifier = std::make_unique<AddressDeltaNotifier>();
+    }
+    if (fAddressIndex || fSpentIndex) {
+        int index_read_threads = args.GetIntArg("-indexreadthreads", DEFAULT_INDEX_READ_THREADS);
+        if (index_read_threads <= 0) {
+            // -indexreadthreads=0 means autodetect, -indexreadthreads=-n means "leave n cores free"
+            index_read_threads += GetNumCores();
+        }
+        // Subtract 1 because the RPC thread takes part in each query, as the
+        // index sync thread does in a bulk build
+        index_read_threads = std::min(std::max(index_read_threads - 1, 0), MAX_INDEX_READ_THREADS);
+        LogPrintf("Address and spent index reads use %d additional threads\n", index_read_threads);
+        if (index_read_threads >= 1) {
+            StartIndexReadWorkerThreads(index_read_threads);
+        }
+    }
+    if (fAddressIndex || fSpentIndex || fTimestampIndex) {
+        g_insightindex = std::make_unique<InsightIndex>(interfaces::MakeChain(node), cache_sizes.insight_index, false, fReindex);
+        if (!WITH_LOCK(cs_main, return g_insightindex->MigrateLegacyEntries(*chainman.m_blockman.m_block_tree_db, chainman.ActiveChain().Tip()))) {
+            return false;
+        }
+        if (!g_insightindex->Start()) {
+            return false;
+        }
+    } else if (!WITH_LOCK(cs_main, return EraseLegacyInsightEntries(*chainman.m_blockman.m_block_tree_db))) {
+        return false;
+    }
+
     for (const auto& filter_type : g_enabled_filter_types) {
         InitBlockFilterIndex([&]{ return interfaces::MakeChain(node); }, filter_type, cache_sizes.filter_index, false, fReindex);
         if (!GetBlockFilterIndex(filter_type)->Start()) {
@@ -5,14 +5,23 @@
 #ifndef BITCOIN_KERNEL_BLOCKMANAGER_OPTS_H
 #define BITCOIN_KERNEL_BLOCKMANAGER_OPTS_H
 
+#include <cstdint>
+
 namespace kernel {
 
+/* YespowerSugar */
+/** -maxmappedblockfiles default. Mapping block files takes address space
+ *  that 32-bit systems do not have to spare. */
+static constexpr int64_t DEFAULT_MAX_MAPPED_BLOCK_FILES{sizeof(void*) >= 8 ? 64 : 0};
+
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
  * `BlockManager::Options` due to the using-declaration in `BlockManager`.
  */
 struct BlockManagerOpts {
     uint64_t prune_target{0};
+    //! Number of blk and rev files kept memory mapped for reads (0 = read through FILE*)
+    int64_t max_mapped_files{DEFAULT_MAX_MAPPED_BLOCK_FILES}; /* YespowerSugar */
 };
 
 } // namespace kernel
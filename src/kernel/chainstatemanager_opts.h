@@ -19,6 +19,10 @@ class CChainParams;
 
 static constexpr bool DEFAULT_CHECKPOINTS_ENABLED{true};
 static constexpr auto DEFAULT_MAX_TIP_AGE{24h};
+/** -blockprefetch default */
+static constexpr int DEFAULT_BLOCK_PREFETCH{16}; /* YespowerSugar */
+/** Maximum -blockprefetch value */
+static constexpr int MAX_BLOCK_PREFETCH{1024}; /* YespowerSugar */
 
 namespace kernel {
 
@@ -42,6 +46,8 @@ struct ChainstateManagerOpts {
     DBOptions block_tree_db{};
     DBOptions coins_db{};
     CoinsViewOptions coins_view{};
+    //! Number of blocks read from disk ahead of connecting them or building indexes from them (0 = off)
+    int block_prefetch{DEFAULT_BLOCK_PREFETCH}; /* YespowerSugar */
 };
 
 } // namespace kernel
@@ -0,0 +1,102 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mempoolindex.h>
+
+#include <crypto/siphash.h>
+#include <primitives/transaction.h>
+#include <random.h>
+
+#include <algorithm>
+
+SaltedAddressHasher::SaltedAddressHasher() : k0(GetRand<uint64_t>()), k1(GetRand<uint64_t>()) {}
+
+size_t SaltedAddressHasher::operator()(const IndexedAddress& address) const noexcept
+{
+    return SipHashUint256Extra(k0, k1, address.hash, address.type);
+}
+
+void CMempoolAddressIndex::Add(const uint256& txhash, const std::vector<Delta>& deltas)
+{
+    if (deltas.empty()) return;
+    const auto [tx, inserted] = m_txs.try_emplace(txhash);
+    if (!inserted) return;
+    if (!m_pooled_addresses.empty()) {
+        tx->second = std::move(m_pooled_addresses.back());
+        m_pooled_addresses.pop_back();
+    }
+
+    for (const Delta& delta : deltas) {
+        const Address address{delta.first.type, delta.first.addressBytes};
+        const auto [it, new_address] = m_addresses.try_emplace(address);
+        if (new_address && !m_pooled_deltas.empty()) {
+            it->second = std::move(m_pooled_deltas.back());
+            m_pooled_deltas.pop_back();
+        }
+        // The deltas of a transaction are appended together, so an address
+        // already has one of them exactly when its last delta is one.
+        if (it->second.empty() || it->second.back().first.txhash != txhash) {
+            tx->second.push_back(address);
+        }
+        it->second.push_back(delta);
+    }
+}
+
+void CMempoolAddressIndex::Remove(const uint256& txhash)
+{
+    const auto tx{m_txs.find(txhash)};
+    if (tx == m_txs.end()) return;
+
+    for (const Address& address : tx->second) {
+        const auto it{m_addresses.find(address)};
+        if (it == m_addresses.end()) continue;
+        std::vector<Delta>& deltas{it->second};
+        deltas.erase(std::remove_if(deltas.begin(), deltas.end(), [&](const Delta& delta) { return delta.first.txhash == txhash; }), deltas.end());
+        if (deltas.empty()) {
+            if (m_pooled_deltas.size() < MAX_POOLED) m_pooled_deltas.push_back(std::move(deltas));
+            m_addresses.erase(it);
+        }
+    }
+
+    if (m_pooled_addresses.size() < MAX_POOLED) {
+        tx->second.clear();
+        m_pooled_addresses.push_back(std::move(tx->second));
+    }
+    m_txs.erase(tx);
+}
+
+void CMempoolAddressIndex::Get(const uint256& address_hash, int type, std::vector<Delta>& results) const
+{
+    const auto it{m_addresses.find(Address{type, address_hash})};
+    if (it == m_addresses.end()) return;
+    const size_t begin{results.size()};
+    results.insert(results.end(), it->second.begin(), it->second.end());
+    std::sort(results.begin() + begin, results.end(), [](const Delta& a, const Delta& b) {
+        return CMempoolAddressDeltaKeyCompare{}(a.first, b.first);
+    });
+}
+
+CMempoolSpentIndex::KeyHasher::KeyHasher() : k0(GetRand<uint64_t>()), k1(GetRand<uint64_t>()) {}
+
+size_t CMempoolSpentIndex::KeyHasher::operator()(const CSpentIndexKey& key) const noexcept
+{
+    return SipHashUint256Extra(k0, k1, key.txid, key.outputIndex);
+}
+
+void CMempoolSpentIndex::Remove(const CTransaction& tx)
+{
+    const uint256& txhash{tx.GetHash()};
+    for (const CTxIn& input : tx.vin) {
+        const auto it{m_spent.find(CSpentIndexKey(input.prevout.hash, input.prevout.n))};
+        if (it != m_spent.end() && it->second.txid == txhash) m_spent.erase(it);
+    }
+}
+
+bool CMempoolSpentIndex::Get(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    const auto it{m_spent.find(key)};
+    if (it == m_spent.end()) return false;
+    value = it->second;
+    return true;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_MEMPOOLINDEX_H
+#define BITCOIN_MEMPOOLINDEX_H
+
+#include <addressindex.h>
+#include <spentindex.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class CTransaction;
+
+/** An address as the insight index identifies it: address type and hash. */
+struct IndexedAddress {
+    int type;
+    uint256 hash;
+
+    friend bool operator==(const IndexedAddress& a, const IndexedAddress& b) { return a.type == b.type && a.hash == b.hash; }
+};
+
+class SaltedAddressHasher
+{
+    const uint64_t k0, k1;
+
+public:
+    SaltedAddressHasher();
+    size_t operator()(const IndexedAddress& address) const noexcept;
+};
+
+/**
+ * Mempool part of -addressindex: the deltas of unconfirmed transactions,
+ * grouped by address.
+ *
+ * Every address owns one flat vector of deltas in a hash table keyed by the
+ * salted address hash, so indexing a transaction appends to a few vectors
+ * instead of allocating a tree node per input and output, and a lookup reads
+ * one contiguous bucket. The vectors of addresses and transactions that leave
+ * the mempool are pooled and reused for the next ones that enter it.
+ */
+class CMempoolAddressIndex
+{
+public:
+    using Delta = std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>;
+
+    /** Index the deltas of a transaction. Does nothing if it is already indexed. */
+    void Add(const uint256& txhash, const std::vector<Delta>& deltas);
+    /** Remove the deltas of a transaction. */
+    void Remove(const uint256& txhash);
+    /** Append the deltas of an address, in CMempoolAddressDeltaKeyCompare order. */
+    void Get(const uint256& address_hash, int type, std::vector<Delta>& results) const;
+
+    bool empty() const { return m_txs.empty(); }
+
+private:
+    using Address = IndexedAddress;
+
+    /** Upper bound on the vectors kept for reuse, per pool. */
+    static constexpr size_t MAX_POOLED{1024};
+
+    std::unordered_map<Address, std::vector<Delta>, SaltedAddressHasher> m_addresses;
+    /** The addresses each indexed transaction has deltas in. */
+    std::unordered_map<uint256, std::vector<Address>, SaltedTxidHasher> m_txs;
+    std::vector<std::vector<Delta>> m_pooled_deltas;
+    std::vector<std::vector<Address>> m_pooled_addresses;
+};
+
+/**
+ * Mempool part of -spentindex: the spending input of every output spent by
+ * an unconfirmed transaction, in a hash table keyed by the salted outpoint.
+ * Entries are found again from the inputs of the removed transaction, so no
+ * per-transaction record is kept.
+ */
+class CMempoolSpentIndex
+{
+public:
+    void Add(const CSpentIndexKey& key, const CSpentIndexValue& value) { m_spent.emplace(key, value); }
+    /** Remove the entries of the inputs of a transaction. */
+    void Remove(const CTransaction& tx);
+    bool Get(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+
+    bool empty() const { return m_spent.empty(); }
+
+private:
+    class KeyHasher
+    {
+        const uint64_t k0, k1;
+
+    public:
+        KeyHasher();
+        size_t operator()(const CSpentIndexKey& key) const noexcept;
+    };
+
+    struct KeyEqual {
+        bool operator()(const CSpentIndexKey& a, const CSpentIndexKey& b) const { return a.outputIndex == b.outputIndex && a.txid == b.txid; }
+    };
+
+    std::unordered_map<CSpentIndexKey, CSpentIndexValue, KeyHasher, KeyEqual> m_spent;
+};
+
+#endif // BITCOIN_MEMPOOLINDEX_H
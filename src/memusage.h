@@ -7,6 +7,7 @@
 
 #include <indirectmap.h>
 #include <prevector.h>
+#include <slabhashmap.h>
 
 #include <cassert>
 #include <cstdlib>
@@ -166,6 +167,13 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template<typename X, typename Y, typename Z>
+static inline size_t DynamicUsage(const SlabHashMap<X, Y, Z>& m)
+{
+    return MallocUsage(sizeof(typename SlabHashMap<X, Y, Z>::Slab)) * m.slab_count() + MallocUsage(sizeof(void*) * m.slab_capacity()) +
+           MallocUsage(sizeof(typename SlabHashMap<X, Y, Z>::Slot) * m.bucket_count());
+}
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
@@ -51,6 +51,7 @@
 #include <optional>
 #include <typeinfo>
 
+using node::RawBlock;
 using node::ReadBlockFromDisk;
 using node::ReadRawBlockFromDisk;
 
@@ -2215,11 +2216,14 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
         // as the network format matches the format on disk
-        std::vector<uint8_t> block_data;
+        /* YespowerSugar */
+        // The bytes are serialized into the message straight from the
+        // mapping of the block file.
+        RawBlock block_data;
         if (!ReadRawBlockFromDisk(block_data, pindex->GetBlockPos(), m_chainparams.MessageStart())) {
             assert(!"cannot load block from disk");
         }
-        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, Span{block_data}));
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, block_data.data));
         // Don't set pblock as we've sent the block
     } else {
         // Send block from disk
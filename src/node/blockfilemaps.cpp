@@ -0,0 +1,108 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockfilemaps.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <limits>
+
+namespace node {
+std::shared_ptr<const MappedBlockFile> MappedBlockFile::Open(const fs::path& path)
+{
+#ifndef WIN32
+    const int fd{open(fs::PathToString(path).c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd == -1) return nullptr;
+    struct stat st;
+    void* base{MAP_FAILED};
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && static_cast<uint64_t>(st.st_size) <= std::numeric_limits<size_t>::max()) {
+        base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // The mapping keeps its own reference to the file.
+    close(fd);
+    if (base == MAP_FAILED) return nullptr;
+    // Records are read one at a time at scattered positions, so read-ahead
+    // past a record is mostly wasted; WillNeed covers the record itself.
+    madvise(base, st.st_size, MADV_RANDOM);
+    return std::shared_ptr<const MappedBlockFile>{new MappedBlockFile{static_cast<const uint8_t*>(base), static_cast<size_t>(st.st_size)}};
+#else
+    return nullptr;
+#endif
+}
+
+MappedBlockFile::~MappedBlockFile()
+{
+#ifndef WIN32
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
+
+void MappedBlockFile::WillNeed(Span<const uint8_t> range) const
+{
+#ifndef WIN32
+    if (range.empty()) return;
+    // madvise wants a page aligned start.
+    static const uintptr_t page_size{static_cast<uintptr_t>(sysconf(_SC_PAGESIZE))};
+    const uintptr_t begin{reinterpret_cast<uintptr_t>(range.data()) & ~(page_size - 1)};
+    const uintptr_t end{reinterpret_cast<uintptr_t>(range.data() + range.size())};
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
+
+std::shared_ptr<const MappedBlockFile> BlockFileMapCache::Get(const fs::path& path, uint64_t end)
+{
+    LOCK(m_mutex);
+    if (m_max_files == 0) return nullptr;
+
+    auto it{m_index.find(path)};
+    if (it != m_index.end()) {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        if (end <= it->second->second->Bytes().size()) return it->second->second;
+        // The file grew since it was mapped.
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    std::shared_ptr<const MappedBlockFile> file{MappedBlockFile::Open(path)};
+    if (!file) return nullptr;
+    if (m_entries.size() >= m_max_files) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+    m_entries.emplace_front(path, file);
+    m_index.emplace(path, m_entries.begin());
+    if (end > file->Bytes().size()) return nullptr;
+    return file;
+}
+
+void BlockFileMapCache::Erase(const fs::path& path)
+{
+    LOCK(m_mutex);
+    if (auto it{m_index.find(path)}; it != m_index.end()) {
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+}
+
+void BlockFileMapCache::SetMaxFiles(size_t max_files)
+{
+    LOCK(m_mutex);
+    m_max_files = max_files;
+    while (m_entries.size() > m_max_files) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+size_t BlockFileMapCache::Size() const
+{
+    LOCK(m_mutex);
+    return m_entries.size();
+}
+} // namespace node
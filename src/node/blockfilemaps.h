@@ -0,0 +1,82 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKFILEMAPS_H
+#define BITCOIN_NODE_BLOCKFILEMAPS_H
+
+#include <span.h>
+#include <sync.h>
+#include <util/fs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace node {
+/* YespowerSugar */
+/**
+ * A read-only memory mapping of a blk or rev file, as large as the file was
+ * when it was mapped. The mapping stays readable for as long as the object
+ * lives, even after the file was pruned.
+ */
+class MappedBlockFile
+{
+    const uint8_t* const m_data;
+    const size_t m_size;
+
+    MappedBlockFile(const uint8_t* data, size_t size) : m_data{data}, m_size{size} {}
+
+public:
+    /** Map a file. Returns nullptr if it is empty or cannot be mapped. */
+    static std::shared_ptr<const MappedBlockFile> Open(const fs::path& path);
+
+    ~MappedBlockFile();
+    MappedBlockFile(const MappedBlockFile&) = delete;
+    MappedBlockFile& operator=(const MappedBlockFile&) = delete;
+
+    Span<const uint8_t> Bytes() const { return {m_data, m_size}; }
+
+    /** Hint that a range of the mapping is about to be read in full. */
+    void WillNeed(Span<const uint8_t> range) const;
+};
+
+/**
+ * Bounded least-recently-used set of mapped blk and rev files, so that reads
+ * of blocks and undo data need no open, seek and read calls per record. A
+ * file is mapped again when it grew past its mapping; readers keep the old
+ * mapping for as long as they use it. Thread safe.
+ */
+class BlockFileMapCache
+{
+    using Entry = std::pair<fs::path, std::shared_ptr<const MappedBlockFile>>;
+
+    mutable Mutex m_mutex;
+    //! Entries ordered from most to least recently used
+    std::list<Entry> m_entries GUARDED_BY(m_mutex);
+    std::map<fs::path, std::list<Entry>::iterator> m_index GUARDED_BY(m_mutex);
+    size_t m_max_files GUARDED_BY(m_mutex);
+
+public:
+    explicit BlockFileMapCache(size_t max_files) : m_max_files{max_files} {}
+
+    /** Get a mapping of the file at path of at least end bytes. Returns
+     *  nullptr if the file is shorter or cannot be mapped, or if no files
+     *  may be mapped. */
+    std::shared_ptr<const MappedBlockFile> Get(const fs::path& path, uint64_t end) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Forget the mapping of a file, before it is removed. */
+    void Erase(const fs::path& path) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Change the number of files kept mapped, unmapping the least recently
+     *  used ones beyond it. */
+    void SetMaxFiles(size_t max_files) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKFILEMAPS_H
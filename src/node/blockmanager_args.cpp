@@ -7,6 +7,8 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <algorithm>
+
 namespace node {
 std::optional<bilingual_str> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Options& opts)
 {
@@ -25,6 +27,9 @@ std::optional<bilingual_str> ApplyArgsManOptions(const ArgsManager& args, BlockM
     }
     opts.prune_target = nPruneTarget;
 
+    /* YespowerSugar */
+    opts.max_mapped_files = std::max<int64_t>(0, args.GetIntArg("-maxmappedblockfiles", opts.max_mapped_files));
+
     return std::nullopt;
 }
 } // namespace node
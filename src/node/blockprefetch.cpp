@@ -0,0 +1,105 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockprefetch.h>
+
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <tinyformat.h>
+#include <util/syscall_sandbox.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+
+namespace node {
+BlockPrefetcher::BlockPrefetcher(const Consensus::Params& params, size_t depth, int threads, Check check)
+    : m_params{params}, m_depth{depth}, m_check{std::move(check)}
+{
+    threads = std::clamp<int>(threads, 1, std::min<size_t>(MAX_BLOCK_PREFETCH_THREADS, std::max<size_t>(depth, 1)));
+    for (int n = 0; n < threads; ++n) {
+        m_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("prefetch.%i", n));
+            SetSyscallSandboxPolicy(SyscallSandboxPolicy::TX_INDEX);
+            Loop();
+        });
+    }
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_work_cv.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void BlockPrefetcher::Loop()
+{
+    while (true) {
+        std::shared_ptr<Entry> entry;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_unread.empty(); });
+            if (m_stop) return;
+            entry = std::move(m_unread.front());
+            m_unread.pop_front();
+        }
+
+        auto block{std::make_shared<CBlock>()};
+        const bool read{ReadBlockFromDisk(*block, entry->pos, entry->hash, m_params)};
+        if (read && m_check) m_check(*block);
+
+        {
+            LOCK(m_mutex);
+            if (read) entry->block = std::move(block);
+            entry->done = true;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+bool BlockPrefetcher::Prefetch(const uint256& hash, const FlatFilePos& pos)
+{
+    {
+        LOCK(m_mutex);
+        if (std::any_of(m_entries.begin(), m_entries.end(), [&](const auto& entry) { return entry->hash == hash; })) return true;
+        if (m_entries.size() >= m_depth) return false;
+        auto entry{std::make_shared<Entry>(hash, pos)};
+        m_entries.push_back(entry);
+        m_unread.push_back(std::move(entry));
+    }
+    m_work_cv.notify_one();
+    return true;
+}
+
+std::shared_ptr<const CBlock> BlockPrefetcher::Take(const uint256& hash)
+{
+    WAIT_LOCK(m_mutex, lock);
+    const auto it{std::find_if(m_entries.begin(), m_entries.end(), [&](const auto& entry) { return entry->hash == hash; })};
+    const std::shared_ptr<Entry> entry{it == m_entries.end() ? nullptr : *it};
+    // Reading a block that no helper thread has started on here beats
+    // waiting for one of them to get to it.
+    const bool unread{entry && std::find(m_unread.begin(), m_unread.end(), entry) != m_unread.end()};
+
+    // The blocks before it (or all of them, if it was not queued) were left
+    // behind, e.g. by a reorganization. A helper thread that is reading one
+    // of them drops the result.
+    const auto end{entry ? std::next(it) : it};
+    for (auto drop{m_entries.begin()}; drop != end; ++drop) {
+        m_unread.erase(std::remove(m_unread.begin(), m_unread.end(), *drop), m_unread.end());
+    }
+    m_entries.erase(m_entries.begin(), end);
+
+    if (!entry || unread) return nullptr;
+    m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return entry->done; });
+    return entry->block;
+}
+
+size_t BlockPrefetcher::Size()
+{
+    LOCK(m_mutex);
+    return m_entries.size();
+}
+} // namespace node
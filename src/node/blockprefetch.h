@@ -0,0 +1,99 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKPREFETCH_H
+#define BITCOIN_NODE_BLOCKPREFETCH_H
+
+#include <flatfile.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CBlock;
+namespace Consensus {
+struct Params;
+}
+
+namespace node {
+/** Maximum number of threads of a BlockPrefetcher */
+static constexpr int MAX_BLOCK_PREFETCH_THREADS{8};
+
+/* YespowerSugar */
+/**
+ * Reads the blocks that a sequential consumer (connecting blocks to the chain
+ * or building an index) is about to need on helper threads, so that reading
+ * and deserializing them overlaps with processing the ones before. At most
+ * depth blocks are held, read or waiting to be read, at a time.
+ *
+ * A check can be passed to run on the helper thread after a block was read,
+ * e.g. the context-free checks of CheckBlock, whose result is cached in the
+ * block.
+ *
+ * Blocks must be taken in the order they were queued; taking a block drops
+ * the ones queued before it.
+ */
+class BlockPrefetcher
+{
+public:
+    using Check = std::function<void(const CBlock& block)>;
+
+private:
+    struct Entry {
+        const uint256 hash;
+        const FlatFilePos pos;
+        //! Set under m_mutex. Null once read if the block could not be read.
+        bool done{false};
+        std::shared_ptr<const CBlock> block;
+
+        Entry(const uint256& hash_in, const FlatFilePos& pos_in) : hash{hash_in}, pos{pos_in} {}
+    };
+
+    const Consensus::Params& m_params;
+    const size_t m_depth;
+    const Check m_check;
+
+    Mutex m_mutex;
+    //! Wakes the helper threads when a block was queued or they should stop
+    std::condition_variable m_work_cv;
+    //! Wakes the consumer when a block was read
+    std::condition_variable m_done_cv;
+    //! Blocks that were queued and not taken yet, in order
+    std::deque<std::shared_ptr<Entry>> m_entries GUARDED_BY(m_mutex);
+    //! Blocks that no helper thread has started to read yet, in order
+    std::deque<std::shared_ptr<Entry>> m_unread GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+public:
+    BlockPrefetcher(const Consensus::Params& params, size_t depth, int threads, Check check = {});
+    ~BlockPrefetcher();
+
+    BlockPrefetcher(const BlockPrefetcher&) = delete;
+    BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+    /** Queue the block stored at pos under hash in the block index, unless it
+     *  already is. Returns false if depth blocks are held already. */
+    bool Prefetch(const uint256& hash, const FlatFilePos& pos) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Take a queued block, waiting for it to be read if a helper thread is
+     *  at it. Returns null if the block was not queued, could not be read, or
+     *  no helper thread has started on it, in which case the caller reads it
+     *  itself. A block that was not queued drops all others, since they will
+     *  not be taken in order anymore. */
+    std::shared_ptr<const CBlock> Take(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKPREFETCH_H
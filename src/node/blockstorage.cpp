@@ -7,10 +7,12 @@
 #include <chain.h>
 #include <clientversion.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <flatfile.h>
 #include <hash.h>
 #include <logging.h>
 #include <kernel/chainparams.h>
+#include <node/blockfilemaps.h>
 #include <pow.h>
 #include <reverse_iterator.h>
 #include <shutdown.h>
@@ -27,6 +29,24 @@
 
 namespace node {
 std::atomic_bool fReindex(false);
+std::atomic_bool g_check_block_read_pow{DEFAULT_CHECK_BLOCK_READ_POW}; /* YespowerSugar */
+
+/* YespowerSugar */
+/** Mapped blk and rev files, shared by all readers; see MapRecord(). */
+static BlockFileMapCache g_block_file_maps{0};
+
+BlockFileMapCache& GetBlockFileMaps()
+{
+    return g_block_file_maps;
+}
+
+BlockManager::BlockManager(Options opts)
+    : m_prune_mode{opts.prune_target > 0},
+      m_opts{std::move(opts)}
+{
+    /* YespowerSugar */
+    g_block_file_maps.SetMaxFiles(m_opts.max_mapped_files);
+}
 
 bool CBlockIndexWorkComparator::operator()(const CBlockIndex* pa, const CBlockIndex* pb) const
 {
@@ -55,6 +75,8 @@ bool CBlockIndexHeightOnlyComparator::operator()(const CBlockIndex* pa, const CB
 static FILE* OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false);
 static FlatFileSeq BlockFileSeq();
 static FlatFileSeq UndoFileSeq();
+static bool MapRecord(const FlatFileSeq& seq, const FlatFilePos& pos, size_t trailer_size,
+                      std::shared_ptr<const MappedBlockFile>& file, Span<const uint8_t>& record);
 
 std::vector<CBlockIndex*> BlockManager::GetAllBlockIndices()
 {
@@ -111,10 +133,35 @@ CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockInde
     }
 
     m_dirty_blockindex.insert(pindexNew);
+    RememberPoWHash(block); /* YespowerSugar */
 
     return pindexNew;
 }
 
+/* YespowerSugar */
+bool BlockManager::SeedPoWHash(const CBlockHeader& header)
+{
+    AssertLockHeld(cs_main);
+
+    const uint256 block_hash{header.GetHash()};
+    if (header.GetCachedPoWHash(block_hash)) return true;
+    const std::optional<uint256> pow_hash{m_pow_hash_cache.Get(block_hash)};
+    if (!pow_hash) return false;
+    header.SetPoWHashCache(block_hash, *pow_hash);
+    return true;
+}
+
+void BlockManager::RememberPoWHash(const CBlockHeader& header)
+{
+    AssertLockHeld(cs_main);
+
+    const uint256 block_hash{header.GetHash()};
+    const std::optional<uint256> pow_hash{header.GetCachedPoWHash(block_hash)};
+    if (!pow_hash || m_pow_hash_cache.Contains(block_hash)) return;
+    m_pow_hash_cache.Insert(block_hash, *pow_hash);
+    m_dirty_pow_hashes.emplace_back(block_hash, *pow_hash);
+}
+
 void BlockManager::PruneOneBlockFile(const int fileNumber)
 {
     AssertLockHeld(cs_main);
@@ -254,7 +301,8 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
 
 bool BlockManager::LoadBlockIndex(const Consensus::Params& consensus_params)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); })) {
+    m_pow_hash_backfill.clear();
+    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_pow_hash_backfill)) {
         return false;
     }
 
@@ -311,9 +359,10 @@ bool BlockManager::WriteBlockIndexDB()
         vBlocks.push_back(*it);
         m_dirty_blockindex.erase(it++);
     }
-    if (!m_block_tree_db->WriteBatchSync(vFiles, m_last_blockfile, vBlocks)) {
+    if (!m_block_tree_db->WriteBatchSync(vFiles, m_last_blockfile, vBlocks, m_dirty_pow_hashes)) {
         return false;
     }
+    m_dirty_pow_hashes.clear();
     return true;
 }
 
@@ -366,16 +415,49 @@ bool BlockManager::LoadBlockIndexDB(const Consensus::Params& consensus_params)
     m_block_tree_db->ReadReindexing(fReindexing);
     if (fReindexing) fReindex = true;
 
-    m_block_tree_db->ReadFlag("addressindex", fAddressIndex);
-    LogPrintf("LoadBlockIndexDB(): address index %s\n", fAddressIndex ? "enabled" : "disabled");
+    return true;
+}
 
-    m_block_tree_db->ReadFlag("timestampindex", fTimestampIndex);
-    LogPrintf("LoadBlockIndexDB(): timestamp index %s\n", fTimestampIndex ? "enabled" : "disabled");
+/* YespowerSugar */
+void BlockManager::BackfillPoWHashes()
+{
+    std::vector<CBlockIndex*> missing;
+    {
+        LOCK(cs_main);
+        missing.swap(m_pow_hash_backfill);
+    }
+    if (missing.empty()) {
+        return;
+    }
+    std::sort(missing.begin(), missing.end(), CBlockIndexHeightOnlyComparator());
+    LogPrintf("Backfilling proof-of-work hashes for %u block index entries\n", missing.size());
+
+    constexpr size_t BACKFILL_BATCH_SIZE{1000};
+    std::vector<std::pair<uint256, uint256>> pow_hashes;
+    pow_hashes.reserve(BACKFILL_BATCH_SIZE);
+    for (size_t begin = 0; begin < missing.size(); begin += BACKFILL_BATCH_SIZE) {
+        if (ShutdownRequested()) {
+            LogPrintf("Shutdown requested. Exit %s\n", __func__);
+            return;
+        }
+        const size_t end{std::min(begin + BACKFILL_BATCH_SIZE, missing.size())};
 
-    m_block_tree_db->ReadFlag("spentindex", fSpentIndex);
-    LogPrintf("LoadBlockIndexDB(): spent index %s\n", fSpentIndex ? "enabled" : "disabled");
+        // The header fields and pprev of an index entry never change once it
+        // has been inserted, so they can be read without cs_main.
+        pow_hashes.clear();
+        for (size_t i = begin; i < end; ++i) {
+            pow_hashes.emplace_back(missing[i]->GetBlockHash(), missing[i]->GetBlockHeader().GetPoWHash());
+        }
 
-    return true;
+        LOCK(cs_main);
+        if (!m_block_tree_db->WritePoWHashes(pow_hashes)) {
+            LogPrintf("%s: failed to write proof-of-work hashes\n", __func__);
+            return;
+        }
+        if (end == missing.size() || (end / BACKFILL_BATCH_SIZE) % 100 == 0) {
+            LogPrintf("Backfilled proof-of-work hashes: %u/%u\n", end, missing.size());
+        }
+    }
 }
 
 void BlockManager::ScanAndUnlinkAlreadyPrunedFiles()
@@ -512,6 +594,27 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
         return error("%s: no undo data available", __func__);
     }
 
+    /* YespowerSugar */
+    std::shared_ptr<const MappedBlockFile> file;
+    Span<const uint8_t> record;
+    if (MapRecord(UndoFileSeq(), pos, sizeof(uint256), file, record)) {
+        const Span<const uint8_t> undo_data{record.subspan(BLOCK_SERIALIZATION_HEADER_SIZE, record.size() - BLOCK_SERIALIZATION_HEADER_SIZE - sizeof(uint256))};
+        // The checksum covers the bytes as written, so it is verified before
+        // they are deserialized.
+        HashWriter hasher{};
+        hasher << pindex->pprev->GetBlockHash();
+        hasher.write(MakeByteSpan(undo_data));
+        if (uint256{record.last(sizeof(uint256))} != hasher.GetHash()) {
+            return error("%s: Checksum mismatch", __func__);
+        }
+        try {
+            SpanReader{SER_DISK, CLIENT_VERSION, undo_data} >> blockundo;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+        }
+        return true;
+    }
+
     // Open history file to read
     AutoFile filein{OpenUndoFile(pos, true)};
     if (filein.IsNull()) {
@@ -583,6 +686,11 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
     std::error_code ec;
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         FlatFilePos pos(*it, 0);
+        /* YespowerSugar */
+        // A file of the same name created later must not be read through
+        // the mapping of the removed one.
+        g_block_file_maps.Erase(BlockFileSeq().FileName(pos));
+        g_block_file_maps.Erase(UndoFileSeq().FileName(pos));
         const bool removed_blockfile{fs::remove(BlockFileSeq().FileName(pos), ec)};
         const bool removed_undofile{fs::remove(UndoFileSeq().FileName(pos), ec)};
         if (removed_blockfile || removed_undofile) {
@@ -617,6 +725,33 @@ fs::path GetBlockPosFilename(const FlatFilePos& pos)
     return BlockFileSeq().FileName(pos);
 }
 
+/* YespowerSugar */
+/**
+ * Find the record at pos of a blk or rev file in the mapping of the file: the
+ * message start and size written in front of it by WriteBlockToDisk or
+ * UndoWriteToDisk, that many bytes and trailer_size bytes after them. Returns
+ * false if the record is not in a mapping, in which case the caller reads it
+ * through a FILE* instead, which also reports why it cannot be read.
+ */
+static bool MapRecord(const FlatFileSeq& seq, const FlatFilePos& pos, size_t trailer_size,
+                      std::shared_ptr<const MappedBlockFile>& file, Span<const uint8_t>& record)
+{
+    if (pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) return false;
+    const fs::path path{seq.FileName(pos)};
+    file = g_block_file_maps.Get(path, pos.nPos);
+    if (!file) return false;
+    const uint32_t size{ReadLE32(file->Bytes().data() + pos.nPos - sizeof(uint32_t))};
+    if (size > MAX_SIZE) return false;
+    const uint64_t end{uint64_t{pos.nPos} + size + trailer_size};
+    if (end > file->Bytes().size()) {
+        file = g_block_file_maps.Get(path, end);
+        if (!file) return false;
+    }
+    record = file->Bytes().subspan(pos.nPos - BLOCK_SERIALIZATION_HEADER_SIZE, BLOCK_SERIALIZATION_HEADER_SIZE + size + trailer_size);
+    file->WillNeed(record);
+    return true;
+}
+
 bool BlockManager::FindBlockPos(FlatFilePos& pos, unsigned int nAddSize, unsigned int nHeight, CChain& active_chain, uint64_t nTime, bool fKnown)
 {
     LOCK(cs_LastBlockFile);
@@ -747,25 +882,37 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+/* YespowerSugar */
+static bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams, bool check_pow)
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
-    }
+    /* YespowerSugar */
+    std::shared_ptr<const MappedBlockFile> file;
+    Span<const uint8_t> record;
+    if (MapRecord(BlockFileSeq(), pos, 0, file, record)) {
+        try {
+            SpanReader{SER_DISK, CLIENT_VERSION, record.subspan(BLOCK_SERIALIZATION_HEADER_SIZE)} >> block;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s at %s", __func__, e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+        }
 
-    // Read block
-    try {
-        filein >> block;
-    } catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        // Read block
+        try {
+            filein >> block;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
     }
 
     // Check the header
-    if (!CheckProofOfWork(block.GetPoWHash_cached(), block.nBits, consensusParams)) {
+    if (check_pow && !CheckProofOfWork(block.GetPoWHash_cached(), block.nBits, consensusParams)) {
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
     }
 
@@ -777,22 +924,50 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
 {
-    const FlatFilePos block_pos{WITH_LOCK(cs_main, return pindex->GetBlockPos())};
+    return ReadBlockFromDisk(block, pos, consensusParams, /*check_pow=*/true);
+}
 
-    if (!ReadBlockFromDisk(block, block_pos, consensusParams)) {
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const uint256& hash, const Consensus::Params& consensusParams)
+{
+    /* YespowerSugar */
+    // The header of a block index entry passed CheckProofOfWork before it was
+    // added, so a block whose hash matches it has valid proof of work too and
+    // the yespower hash, which costs far more than reading the block, can be
+    // skipped unless -checkblockreadpow asks for it.
+    if (!ReadBlockFromDisk(block, pos, consensusParams, /*check_pow=*/g_check_block_read_pow)) {
         return false;
     }
-    if (block.GetHash() != pindex->GetBlockHash()) {
-        return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
-                     pindex->ToString(), block_pos.ToString());
+    if (block.GetHash() != hash) {
+        return error("ReadBlockFromDisk: GetHash() doesn't match index for block %s at %s",
+                     hash.ToString(), pos.ToString());
     }
     return true;
 }
 
-bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
+bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
+    const FlatFilePos block_pos{WITH_LOCK(cs_main, return pindex->GetBlockPos())};
+    return ReadBlockFromDisk(block, block_pos, pindex->GetBlockHash(), consensusParams);
+}
+
+bool ReadRawBlockFromDisk(RawBlock& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
+{
+    /* YespowerSugar */
+    std::shared_ptr<const MappedBlockFile> file;
+    Span<const uint8_t> record;
+    if (MapRecord(BlockFileSeq(), pos, 0, file, record)) {
+        if (memcmp(record.data(), message_start, CMessageHeader::MESSAGE_START_SIZE)) {
+            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                         HexStr(record.first(CMessageHeader::MESSAGE_START_SIZE)),
+                         HexStr(message_start));
+        }
+        block.data = record.subspan(BLOCK_SERIALIZATION_HEADER_SIZE);
+        block.owner = std::move(file);
+        return true;
+    }
+
     FlatFilePos hpos = pos;
     hpos.nPos -= 8; // Seek back 8 bytes for meta header
     AutoFile filein{OpenBlockFile(hpos, true)};
@@ -817,8 +992,10 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, c
                          blk_size, MAX_SIZE);
         }
 
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read(MakeWritableByteSpan(block));
+        auto buffer{std::make_shared<std::vector<uint8_t>>(blk_size)}; // Zeroing of memory is intentional here
+        filein.read(MakeWritableByteSpan(*buffer));
+        block.data = *buffer;
+        block.owner = std::move(buffer);
     } catch (const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -943,5 +1120,8 @@ void ThreadImport(ChainstateManager& chainman, std::vector<fs::path> vImportFile
         }
     } // End scope of ImportingNow
     chainman.ActiveChainstate().LoadMempool(mempool_path);
+
+    /* YespowerSugar */
+    chainman.m_blockman.BackfillPoWHashes();
 }
 } // namespace node
@@ -9,13 +9,17 @@
 #include <chain.h>
 #include <kernel/blockmanager_opts.h>
 #include <kernel/cs_main.h>
+#include <node/powhashcache.h>
+#include <pow.h>
 #include <protocol.h>
+#include <span.h>
 #include <sync.h>
 #include <txdb.h>
 #include <util/fs.h>
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -35,6 +39,8 @@ struct Params;
 }
 
 namespace node {
+class BlockFileMapCache; /* YespowerSugar */
+
 static constexpr bool DEFAULT_STOPAFTERBLOCKIMPORT{false};
 
 /** The pre-allocation chunk size for blk?????.dat files (since 0.8) */
@@ -49,6 +55,13 @@ static constexpr size_t BLOCK_SERIALIZATION_HEADER_SIZE = CMessageHeader::MESSAG
 
 extern std::atomic_bool fReindex;
 
+/* YespowerSugar */
+/** -checkblockreadpow default */
+static constexpr bool DEFAULT_CHECK_BLOCK_READ_POW{false};
+/** Whether blocks read for a block index entry have their proof of work
+ *  recomputed, instead of only being matched against the entry's hash. */
+extern std::atomic_bool g_check_block_read_pow;
+
 // Because validation code takes pointers to the map's CBlockIndex objects, if
 // we ever switch to another associative container, we need to either use a
 // container that has stable addressing (true of all std associative
@@ -130,6 +143,16 @@ private:
     /** Dirty block file entries. */
     std::set<int> m_dirty_fileinfo;
 
+    /* YespowerSugar */
+    /** PoW hashes of recently seen headers. Index entries don't carry one. */
+    PoWHashCache m_pow_hash_cache GUARDED_BY(::cs_main);
+
+    /** PoW hashes not yet written to the block tree db. */
+    std::vector<std::pair<uint256, uint256>> m_dirty_pow_hashes GUARDED_BY(::cs_main);
+
+    /** Index entries loaded without a stored PoW hash, see BackfillPoWHashes(). */
+    std::vector<CBlockIndex*> m_pow_hash_backfill GUARDED_BY(::cs_main);
+
     /**
      * Map from external index name to oldest block that must not be pruned.
      *
@@ -143,14 +166,16 @@ private:
 public:
     using Options = kernel::BlockManagerOpts;
 
-    explicit BlockManager(Options opts)
-        : m_prune_mode{opts.prune_target > 0},
-          m_opts{std::move(opts)} {};
+    explicit BlockManager(Options opts);
 
     std::atomic<bool> m_importing{false};
 
     BlockMap m_block_index GUARDED_BY(cs_main);
 
+    /* SugarShield */
+    /** Difficulty averaging window along the most recently checked chain of headers. */
+    DifficultyWindow m_difficulty_window GUARDED_BY(::cs_main);
+
     std::vector<CBlockIndex*> GetAllBlockIndices() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     /**
@@ -216,6 +241,27 @@ public:
 
     //! Create or update a prune lock identified by its name
     void UpdatePruneLock(const std::string& name, const PruneLockInfo& lock_info) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /* YespowerSugar */
+    /**
+     * Fill in the header's cached PoW hash from m_pow_hash_cache, so
+     * validating a header seen before doesn't recompute yespower.
+     * Returns whether the PoW hash was known.
+     */
+    bool SeedPoWHash(const CBlockHeader& header) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Remember the PoW hash the header has computed, if any, and queue it for
+     * the next block tree db flush.
+     */
+    void RememberPoWHash(const CBlockHeader& header) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Compute and store the PoW hash of every block index entry that was
+     * loaded without one, e.g. from a block tree written by an older version.
+     * Hashing happens without holding cs_main; returns early on shutdown.
+     */
+    void BackfillPoWHashes() EXCLUSIVE_LOCKS_REQUIRED(!::cs_main);
 };
 
 void CleanupBlockRevFiles();
@@ -231,12 +277,29 @@ fs::path GetBlockPosFilename(const FlatFilePos& pos);
 void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune);
 
 /** Functions for disk access for blocks */
+/** Read the block at pos and check its proof of work. */
 bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams);
+/** Read the block of pindex and check that its hash matches the entry, whose
+ *  header passed the proof of work check when it was accepted. */
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
-bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
+/** The same for the entry with hash whose block is at pos, without cs_main. */
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const uint256& hash, const Consensus::Params& consensusParams);
+/* YespowerSugar */
+/** The serialized bytes of a block, valid for as long as owner is held. They
+ *  point into the mapping of the block file, or into a buffer if the file
+ *  could not be mapped. */
+struct RawBlock {
+    std::shared_ptr<const void> owner;
+    Span<const uint8_t> data;
+};
+bool ReadRawBlockFromDisk(RawBlock& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 
 bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
 
+/* YespowerSugar */
+/** The mapped blk and rev files that block and undo reads go through. */
+BlockFileMapCache& GetBlockFileMaps();
+
 void ThreadImport(ChainstateManager& chainman, std::vector<fs::path> vImportFiles, const ArgsManager& args, const fs::path& mempool_path);
 } // namespace node
 
@@ -4,9 +4,11 @@
 
 #include <node/caches.h>
 
+#include <index/insightindex.h>
 #include <index/txindex.h>
 #include <txdb.h>
 #include <util/system.h>
+#include <validation.h>
 
 namespace node {
 CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes)
@@ -19,6 +21,11 @@ CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes)
     nTotalCache -= sizes.block_tree_db;
     sizes.tx_index = std::min(nTotalCache / 8, args.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= sizes.tx_index;
+    const bool insight_index{args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ||
+                             args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
+                             args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX)};
+    sizes.insight_index = std::min(nTotalCache / 8, insight_index ? MAX_INSIGHT_INDEX_CACHE << 20 : 0);
+    nTotalCache -= sizes.insight_index;
     sizes.filter_index = 0;
     if (n_indexes > 0) {
         int64_t max_cache = std::min(nTotalCache / 8, max_filter_index_cache << 20);
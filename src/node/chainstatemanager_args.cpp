@@ -15,6 +15,7 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
 #include <optional>
 #include <string>
@@ -37,6 +38,9 @@ std::optional<bilingual_str> ApplyArgsManOptions(const ArgsManager& args, Chains
 
     if (auto value{args.GetIntArg("-maxtipage")}) opts.max_tip_age = std::chrono::seconds{*value};
 
+    /* YespowerSugar */
+    if (auto value{args.GetIntArg("-blockprefetch")}) opts.block_prefetch = std::clamp<int64_t>(*value, 0, MAX_BLOCK_PREFETCH);
+
     ReadDatabaseArgs(args, opts.block_tree_db);
     ReadDatabaseArgs(args, opts.coins_db);
     ReadCoinsViewArgs(args, opts.coins_view);
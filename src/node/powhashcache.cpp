@@ -0,0 +1,46 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/powhashcache.h>
+
+#include <memusage.h>
+
+namespace node {
+void PoWHashCache::Insert(const uint256& block_hash, const uint256& pow_hash)
+{
+    if (m_max_entries == 0) return;
+
+    if (auto it{m_index.find(block_hash)}; it != m_index.end()) {
+        it->second->second = pow_hash;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+    if (m_entries.size() >= m_max_entries) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+    m_entries.emplace_front(block_hash, pow_hash);
+    m_index.emplace(block_hash, m_entries.begin());
+}
+
+std::optional<uint256> PoWHashCache::Get(const uint256& block_hash)
+{
+    auto it{m_index.find(block_hash)};
+    if (it == m_index.end()) return std::nullopt;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+}
+
+size_t PoWHashCache::DynamicMemoryUsage() const
+{
+    // A list node holds the entry plus its two links.
+    return memusage::MallocUsage(sizeof(Entry) + 2 * sizeof(void*)) * m_entries.size() + memusage::DynamicUsage(m_index);
+}
+
+void PoWHashCache::Clear()
+{
+    m_index.clear();
+    m_entries.clear();
+}
+} // namespace node
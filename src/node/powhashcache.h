@@ -0,0 +1,56 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_POWHASHCACHE_H
+#define BITCOIN_NODE_POWHASHCACHE_H
+
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace node {
+/** Default number of entries kept in BlockManager's PoW hash cache. */
+static constexpr size_t DEFAULT_POW_HASH_CACHE_SIZE{50'000};
+
+/* YespowerSugar */
+/**
+ * Bounded least-recently-used map from block hash to yespower PoW hash.
+ *
+ * Keeps the PoW hashes of recently seen headers so that validating the same
+ * header again (e.g. when its block arrives after headers-first sync) does
+ * not recompute yespower, without storing a PoW hash on every CBlockIndex.
+ * Not thread safe; the owner is responsible for locking.
+ */
+class PoWHashCache
+{
+    using Entry = std::pair<uint256, uint256>;
+
+    //! Entries ordered from most to least recently used
+    std::list<Entry> m_entries;
+    std::unordered_map<uint256, std::list<Entry>::iterator, BlockHasher> m_index;
+    const size_t m_max_entries;
+
+public:
+    explicit PoWHashCache(size_t max_entries = DEFAULT_POW_HASH_CACHE_SIZE) : m_max_entries{max_entries} {}
+
+    /** Insert or refresh an entry, evicting the least recently used one if full. */
+    void Insert(const uint256& block_hash, const uint256& pow_hash);
+
+    /** Look up the PoW hash of a block, marking it as recently used. */
+    std::optional<uint256> Get(const uint256& block_hash);
+
+    bool Contains(const uint256& block_hash) const { return m_index.count(block_hash) > 0; }
+    size_t Size() const { return m_entries.size(); }
+    size_t MaxSize() const { return m_max_entries; }
+    size_t DynamicMemoryUsage() const;
+    void Clear();
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_POWHASHCACHE_H
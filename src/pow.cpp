@@ -10,6 +10,8 @@
 #include <primitives/block.h>
 #include <uint256.h>
 
+#include <algorithm>
+
 /*
 SugarShield-N510 is based on Zcash's modification of Digishield (commit 4c90270)
 https://github.com/zcash/zcash/blob/4c90270469e32cbf3459ec2fd25d46a089bd5c58/src/pow.cpp
@@ -74,6 +76,82 @@ unsigned int CalculateNextWorkRequired(arith_uint256 bnAvg,
     return bnNew.GetCompact();
 }
 
+/* SugarShield */
+unsigned int DifficultyWindow::GetNextWorkRequired(const CBlockIndex* pindexLast, const Consensus::Params& params)
+{
+    assert(pindexLast != nullptr);
+
+    // REGTEST: Never retarget
+    if (params.fPowNoRetargeting && params.fPowAllowMinDifficultyBlocks)
+        return pindexLast->nBits;
+
+    if (pindexLast == m_last)
+        return m_next_bits;
+
+    const size_t window = params.nPowAveragingWindow;
+    if (m_last != nullptr && pindexLast->pprev == m_last && m_window.size() == window) {
+        // Slide by one block: the oldest one leaves the window and becomes the block before it
+        Entry& oldest = m_window[m_oldest];
+        m_sum -= oldest.target;
+        m_first = oldest.index;
+        m_first_time = oldest.median_time_past;
+        oldest.index = pindexLast;
+        oldest.target.SetCompact(pindexLast->nBits);
+        oldest.median_time_past = pindexLast->GetMedianTimePast();
+        m_sum += oldest.target;
+        m_oldest = (m_oldest + 1) % window;
+    } else {
+        Rebuild(pindexLast, window);
+    }
+    m_last = pindexLast;
+
+    // Check we have enough blocks
+    if (m_first == nullptr) {
+        m_next_bits = UintToArith256(params.powLimit).GetCompact();
+        return m_next_bits;
+    }
+
+    Entry& newest = m_window[(m_oldest + window - 1) % window];
+    if (newest.median_time_past == UNKNOWN_TIME) newest.median_time_past = newest.index->GetMedianTimePast();
+    if (m_first_time == UNKNOWN_TIME) m_first_time = m_first->GetMedianTimePast();
+
+    arith_uint256 bnAvg {m_sum / window};
+    m_next_bits = CalculateNextWorkRequired(bnAvg, newest.median_time_past, m_first_time, params);
+    return m_next_bits;
+}
+
+void DifficultyWindow::Rebuild(const CBlockIndex* pindexLast, size_t window)
+{
+    m_window.clear();
+    m_window.reserve(window);
+    m_oldest = 0;
+    m_sum = 0;
+
+    const CBlockIndex* pindex = pindexLast;
+    for (size_t i = 0; pindex && i < window; i++) {
+        Entry entry{pindex, arith_uint256{}, UNKNOWN_TIME};
+        entry.target.SetCompact(pindex->nBits);
+        m_sum += entry.target;
+        m_window.push_back(entry);
+        pindex = pindex->pprev;
+    }
+    std::reverse(m_window.begin(), m_window.end());
+
+    m_first = pindex;
+    m_first_time = UNKNOWN_TIME;
+}
+
+void DifficultyWindow::Clear()
+{
+    m_window.clear();
+    m_oldest = 0;
+    m_sum = 0;
+    m_first = nullptr;
+    m_first_time = UNKNOWN_TIME;
+    m_last = nullptr;
+    m_next_bits = 0;
+}
+
 /* BTC */
 /*
 unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params)
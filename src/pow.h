@@ -6,23 +6,70 @@
 #ifndef BITCOIN_POW_H
 #define BITCOIN_POW_H
 
+#include <arith_uint256.h> // SugarShield
 #include <consensus/params.h>
 
+#include <limits>
 #include <stdint.h>
+#include <vector>
 
 class CBlockHeader;
 class CBlockIndex;
 class uint256;
 
-
-class arith_uint256; // SugarShield
-
 /* SugarShield */
 unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params&);
 unsigned int CalculateNextWorkRequired(arith_uint256 bnAvg,
                                        int64_t nLastBlockTime, int64_t nFirstBlockTime,
                                        const Consensus::Params&);
 
+/* SugarShield */
+/**
+ * Incrementally maintained SugarShield averaging window.
+ *
+ * GetNextWorkRequired() walks nPowAveragingWindow blocks back and sums their
+ * targets for every header it checks. This keeps the blocks of the last
+ * window, their running target sum and their median time past, so that
+ * extending the chain by one block costs one SetCompact(), one addition,
+ * one subtraction and one GetMedianTimePast(). Asking for any block that is
+ * not the last one seen or a child of it (a reorg, a competing fork) falls
+ * back to a full walk, which then becomes the new starting point.
+ *
+ * Results are identical to GetNextWorkRequired() as long as the consensus
+ * params stay the same. The window keeps pointers into the block index, so it
+ * must not outlive it. Not thread safe; callers synchronize access.
+ */
+class DifficultyWindow
+{
+public:
+    unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const Consensus::Params& params);
+
+    /** Forget everything, so that the next call does a full walk. */
+    void Clear();
+
+private:
+    struct Entry {
+        const CBlockIndex* index;
+        arith_uint256 target;
+        /** Median time past of the block; UNKNOWN_TIME until needed when filled in by a full walk. */
+        int64_t median_time_past;
+    };
+    static constexpr int64_t UNKNOWN_TIME{std::numeric_limits<int64_t>::min()};
+
+    /** Window blocks in a ring, oldest at m_oldest. Holds fewer entries only near genesis. */
+    std::vector<Entry> m_window;
+    size_t m_oldest{0};
+    arith_uint256 m_sum{0};
+    /** The block before the window, nullptr if the chain is too short. */
+    const CBlockIndex* m_first{nullptr};
+    int64_t m_first_time{UNKNOWN_TIME};
+    /** Last block of the window, and the result for it. */
+    const CBlockIndex* m_last{nullptr};
+    unsigned int m_next_bits{0};
+
+    void Rebuild(const CBlockIndex* pindexLast, size_t window);
+};
+
 /* BTC */
 /*
 unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params&);
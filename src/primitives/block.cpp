@@ -9,11 +9,10 @@
 #include <tinyformat.h>
 
 /* YespowerSugar */
-#include <crypto/yespower-1.0.1/yespower.h>
-#include <streams.h>
-#include <version.h>
+#include <crypto/common.h>
+#include <crypto/yespower.h>
 #include <stdlib.h> // exit()
-#include <sync.h>
+#include <string.h>
 
 uint256 CBlockHeaderUncached::GetHash() const
 {
@@ -31,10 +30,16 @@ uint256 CBlockHeaderUncached::GetPoWHash() const
         .pers = (const uint8_t *)"Satoshi Nakamoto 31/Oct/2008 Proof-of-work is essentially one-CPU-one-vote",
         .perslen = 74
     };
+    // The header has a fixed 80 byte serialization, so skip the stream.
+    uint8_t header[80];
+    WriteLE32(header, nVersion);
+    memcpy(header + 4, hashPrevBlock.begin(), 32);
+    memcpy(header + 36, hashMerkleRoot.begin(), 32);
+    WriteLE32(header + 68, nTime);
+    WriteLE32(header + 72, nBits);
+    WriteLE32(header + 76, nNonce);
     uint256 hash;
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *this;
-    if (yespower_tls((const uint8_t *)&ss[0], ss.size(), &yespower_1_0_sugarchain, (yespower_binary_t *)&hash)) {
+    if (GetYespowerContextPool().Hash(header, sizeof(header), yespower_1_0_sugarchain, (yespower_binary_t *)&hash)) {
         tfm::format(std::cerr, "Error: CBlockHeaderUncached::GetPoWHash(): failed to compute PoW hash (out of memory?)\n");
         exit(1);
     }
@@ -45,22 +50,26 @@ uint256 CBlockHeaderUncached::GetPoWHash() const
 uint256 CBlockHeader::GetPoWHash_cached() const
 {
     uint256 block_hash = GetHash();
-    LOCK(cache_lock);
-    if (cache_init) {
-        if (block_hash != cache_block_hash) {
+    if (m_cache_state.load(std::memory_order_acquire) == CACHE_READY) {
+        if (block_hash != m_cache_block_hash) {
             tfm::format(std::cerr, "Error: CBlockHeader::GetPoWHash_cached(): block hash changed unexpectedly\n");
             exit(1);
         }
-        /* yespower PoW cache log: O (cyan) = HIT */
-        // printf("\033[36;1mO\033[0m block = %s PoW = %s\n", cache_block_hash.ToString().c_str(), cache_PoW_hash.ToString().c_str());
-    } else {
-        cache_PoW_hash = GetPoWHash();
-        cache_block_hash = block_hash;
-        cache_init = true;
-        /* yespower PoW cache log: x = MISS */
-        // printf("x block = %s PoW = %s\n", cache_block_hash.ToString().c_str(), cache_PoW_hash.ToString().c_str());
+        return m_cache_pow_hash;
     }
-    return cache_PoW_hash;
+    const uint256 pow_hash = GetPoWHash();
+    SetPoWHashCache(block_hash, pow_hash);
+    return pow_hash;
+}
+
+void CBlockHeader::SetPoWHashCache(const uint256& block_hash, const uint256& pow_hash) const
+{
+    // Concurrent callers computed the same value; only the first one publishes it.
+    uint8_t expected{CACHE_EMPTY};
+    if (!m_cache_state.compare_exchange_strong(expected, CACHE_WRITING, std::memory_order_acquire, std::memory_order_relaxed)) return;
+    m_cache_block_hash = block_hash;
+    m_cache_pow_hash = pow_hash;
+    m_cache_state.store(CACHE_READY, std::memory_order_release);
 }
 
 std::string CBlock::ToString() const
@@ -11,7 +11,9 @@
 #include <uint256.h>
 #include <util/time.h>
 
-#include <sync.h> /* YespowerSugar */
+/* YespowerSugar */
+#include <atomic>
+#include <optional>
 
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
@@ -72,31 +74,52 @@ public:
 /* YespowerSugar */
 class CBlockHeader : public CBlockHeaderUncached
 {
-public:
-    mutable RecursiveMutex cache_lock; // Do not use CCriticalSection // See https://github.com/bitcoin/bitcoin/pull/17891
-    mutable bool cache_init;
-    mutable uint256 cache_block_hash, cache_PoW_hash;
-
-    CBlockHeader()
-    {
-        cache_init = false;
+private:
+    //! Write-once PoW hash cache. The state only moves forward from EMPTY to
+    //! READY; the hashes are published with a release store on the state and
+    //! read after an acquire load, so readers never need a lock.
+    enum : uint8_t { CACHE_EMPTY, CACHE_WRITING, CACHE_READY };
+    mutable std::atomic<uint8_t> m_cache_state{CACHE_EMPTY};
+    mutable uint256 m_cache_block_hash;
+    mutable uint256 m_cache_pow_hash;
+
+    void CopyCache(const CBlockHeader& header)
+    {
+        if (header.m_cache_state.load(std::memory_order_acquire) == CACHE_READY) {
+            m_cache_block_hash = header.m_cache_block_hash;
+            m_cache_pow_hash = header.m_cache_pow_hash;
+            m_cache_state.store(CACHE_READY, std::memory_order_relaxed);
+        } else {
+            m_cache_state.store(CACHE_EMPTY, std::memory_order_relaxed);
+        }
     }
 
-    CBlockHeader(const CBlockHeader& header)
+public:
+    CBlockHeader() = default;
+
+    CBlockHeader(const CBlockHeader& header) : CBlockHeaderUncached{header}
     {
-        *this = header;
+        CopyCache(header);
     }
 
     CBlockHeader& operator=(const CBlockHeader& header)
     {
-        *(CBlockHeaderUncached*)this = (CBlockHeaderUncached)header;
-        cache_init = header.cache_init;
-        cache_block_hash = header.cache_block_hash;
-        cache_PoW_hash = header.cache_PoW_hash;
+        CBlockHeaderUncached::operator=(header);
+        CopyCache(header);
         return *this;
     }
 
     uint256 GetPoWHash_cached() const;
+
+    /** The cached PoW hash, if one was computed for a header with this block hash. */
+    std::optional<uint256> GetCachedPoWHash(const uint256& block_hash) const
+    {
+        if (m_cache_state.load(std::memory_order_acquire) != CACHE_READY || m_cache_block_hash != block_hash) return std::nullopt;
+        return m_cache_pow_hash;
+    }
+
+    /** Fill the cache with a PoW hash computed elsewhere. No-op if already filled. */
+    void SetPoWHashCache(const uint256& block_hash, const uint256& pow_hash) const;
 };
 
 class CBlock : public CBlockHeader
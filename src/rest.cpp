@@ -5,31 +5,38 @@
 
 #include <rest.h>
 
+#include <addressnotifier.h>
 #include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/insightindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/index.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
+#include <spentindex.h>
 #include <streams.h>
 #include <sync.h>
 #include <txmempool.h>
 #include <util/check.h>
+#include <util/strencodings.h>
 #include <util/system.h>
 #include <validation.h>
 #include <version.h>
 
+#include <algorithm>
 #include <any>
+#include <atomic>
 #include <string>
 
 #include <univalue.h>
@@ -40,6 +47,18 @@ using node::ReadBlockFromDisk;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+static constexpr size_t MAX_REST_ADDRESS_DELTAS{1000};
+/** Most entries one page of a /rest/address/ list query returns. */
+static constexpr size_t MAX_REST_ADDRESS_RESULTS{1000};
+/** Longest time an /rest/addressdeltas/ request waits for a new event. */
+static constexpr std::chrono::seconds MAX_ADDRESS_DELTAS_TIMEOUT{60};
+static constexpr std::chrono::seconds DEFAULT_ADDRESS_DELTAS_TIMEOUT{30};
+/** A waiting /rest/addressdeltas/ request holds an HTTP worker, so at most one
+ *  per this many -rpcthreads (and at least one) may wait at once. */
+static constexpr int RPC_THREADS_PER_ADDRESS_DELTAS_WAITER{4};
+
+/** Number of /rest/addressdeltas/ requests waiting for an event */
+static std::atomic<int> g_address_deltas_waiters{0};
 
 static const struct {
     RESTResponseFormat rf;
@@ -1001,6 +1020,383 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+/**
+ * Long-poll for deltas of the addresses registered with watchaddresses:
+ * /rest/addressdeltas/<sequence>.<ext>?timeout=<seconds> returns the events
+ * after <sequence>, waiting for one if there is none yet.
+ */
+static bool rest_address_deltas(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    uint64_t after;
+    if (!ParseUInt64(param, &after)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid sequence: " + SanitizeString(param));
+    }
+    std::string raw_timeout;
+    try {
+        raw_timeout = req->GetQueryParameter("timeout").value_or(ToString(count_seconds(DEFAULT_ADDRESS_DELTAS_TIMEOUT)));
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto timeout{ToIntegral<int64_t>(raw_timeout)};
+    if (!timeout || *timeout < 0 || *timeout > count_seconds(MAX_ADDRESS_DELTAS_TIMEOUT)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Timeout is invalid or out of acceptable range (0-%d): %s", count_seconds(MAX_ADDRESS_DELTAS_TIMEOUT), raw_timeout));
+    }
+    if (!g_address_notifier) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+
+    // Extra long-polls are turned away rather than let them take the workers
+    // other requests need.
+    const bool wait{*timeout > 0};
+    const int max_waiters{std::max(int(gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS)) / RPC_THREADS_PER_ADDRESS_DELTAS_WAITER, 1)};
+    if (wait && ++g_address_deltas_waiters > max_waiters) {
+        --g_address_deltas_waiters;
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, strprintf("Too many address delta requests are waiting (at most %d), retry later or with timeout=0", max_waiters));
+    }
+    std::vector<AddressDeltaEvent> events;
+    const uint64_t sequence{g_address_notifier->WaitForEvents(after, MAX_REST_ADDRESS_DELTAS, std::chrono::seconds{*timeout}, events)};
+    if (wait) --g_address_deltas_waiters;
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        DataStream ss_deltas{};
+        ss_deltas << sequence << events;
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ss_deltas.str());
+        return true;
+    }
+    case RESTResponseFormat::HEX: {
+        DataStream ss_deltas{};
+        ss_deltas << sequence << events;
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, HexStr(ss_deltas) + "\n");
+        return true;
+    }
+    case RESTResponseFormat::JSON: {
+        UniValue deltas(UniValue::VARR);
+        for (const AddressDeltaEvent& event : events) {
+            deltas.push_back(AddressDeltaEventToJSON(event));
+        }
+        UniValue resp(UniValue::VOBJ);
+        resp.pushKV("sequence", sequence);
+        resp.pushKV("deltas", deltas);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, resp.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/**
+ * Reply with one page of the entries of an address index query: a CompactSize
+ * count, the serialized entries and the cursor of the next page in binary and
+ * hex form, or a JSON object holding the array under `name` and the cursor.
+ * The cursor is empty, or omitted from JSON, after the last page.
+ */
+static bool WriteIndexReply(HTTPRequest* req, RESTResponseFormat rf, uint64_t count, const DataStream& entries,
+                            const std::string& name, const UniValue& json, const std::optional<std::string>& next)
+{
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        const std::vector<uint8_t> cursor{next ? ParseHex(*next) : std::vector<uint8_t>{}};
+        DataStream ss{};
+        ss.reserve(GetSizeOfCompactSize(count) + entries.size() + GetSizeOfCompactSize(cursor.size()) + cursor.size());
+        WriteCompactSize(ss, count);
+        ss.write(Span{entries});
+        ss << cursor;
+        if (rf == RESTResponseFormat::HEX) {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ss) + "\n");
+        } else {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ss);
+        }
+        return true;
+    }
+    case RESTResponseFormat::JSON: {
+        UniValue resp(UniValue::VOBJ);
+        resp.pushKV(name, json);
+        if (next) resp.pushKV("cursor", *next);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, resp.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/**
+ * Decode the cursor of a /rest/address/ page, the serialized index key of the
+ * last entry of the previous page. It has to belong to the queried address.
+ */
+template <typename Key>
+static bool DecodeAddressCursor(const std::optional<std::string>& hex, const uint256& hash, int type, std::optional<Key>& key)
+{
+    if (!hex) return true;
+    if (!IsHex(*hex)) return false;
+    DataStream ss{ParseHex(*hex)};
+    Key decoded;
+    try {
+        ss >> decoded;
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!ss.empty() || decoded.hashBytes != hash || decoded.type != (unsigned int)type) return false;
+    key = decoded;
+    return true;
+}
+
+template <typename Key>
+static std::string EncodeAddressCursor(const Key& key)
+{
+    DataStream ss{};
+    ss << key;
+    return HexStr(ss);
+}
+
+/**
+ * Address index queries without JSON-RPC:
+ * /rest/address/<address>/<utxos|txids|deltas|balance>.<ext>
+ *
+ * Entries are serialized straight from the index iterator in index order, and
+ * the address is only decoded once from the URI, so large wallets skip the
+ * per-entry UniValue objects and address re-encoding of the RPCs. txids and
+ * deltas take optional ?start=<height>&end=<height> bounds. Lists are returned
+ * in pages of at most ?limit=<n> entries (default and at most
+ * MAX_REST_ADDRESS_RESULTS), the next one starting after ?cursor=<hex>.
+ */
+static bool rest_address(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+    if (rf == RESTResponseFormat::UNDEF) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+
+    const std::vector<std::string> path{SplitString(param, '/')};
+    if (path.size() != 2) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/address/<address>/<utxos|txids|deltas|balance>.<ext>");
+    }
+    const std::string& query{path[1]};
+    uint256 hash;
+    int type;
+    if (!getIndexKey(path[0], hash, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(path[0]));
+    }
+
+    int start{0};
+    int end{0};
+    size_t limit{MAX_REST_ADDRESS_RESULTS};
+    std::optional<std::string> cursor;
+    try {
+        const auto start_str{req->GetQueryParameter("start")};
+        const auto end_str{req->GetQueryParameter("end")};
+        if (start_str || end_str) {
+            const auto start_height{ToIntegral<int>(start_str.value_or(""))};
+            const auto end_height{ToIntegral<int>(end_str.value_or(""))};
+            if (!start_height || !end_height || *start_height <= 0 || *end_height < *start_height) {
+                return RESTERR(req, HTTP_BAD_REQUEST, "start and end are expected to be heights with 0 < start <= end");
+            }
+            start = *start_height;
+            end = *end_height;
+        }
+        if (const auto limit_str{req->GetQueryParameter("limit")}) {
+            const auto parsed_limit{ToIntegral<size_t>(*limit_str)};
+            if (!parsed_limit || *parsed_limit < 1 || *parsed_limit > MAX_REST_ADDRESS_RESULTS) {
+                return RESTERR(req, HTTP_BAD_REQUEST, strprintf("limit is expected to be between 1 and %u", MAX_REST_ADDRESS_RESULTS));
+            }
+            limit = *parsed_limit;
+        }
+        cursor = req->GetQueryParameter("cursor");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+
+    if (!fAddressIndex || !g_insightindex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+    if (!g_insightindex->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, strprintf("Address index is still syncing. Current height: %d", g_insightindex->GetSummary().best_block_height));
+    }
+
+    const bool json{rf == RESTResponseFormat::JSON};
+    DataStream entries{};
+    UniValue result(UniValue::VARR);
+    uint64_t count{0};
+    std::optional<std::string> next;
+    bool ok{true};
+    if (query == "utxos") {
+        std::optional<CAddressUnspentKey> after;
+        if (!DecodeAddressCursor(cursor, hash, type, after)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor");
+        }
+        ok = g_insightindex->ScanAddressUnspentIndex(hash, type, after ? &*after : nullptr, [&](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
+            if (json) {
+                UniValue output(UniValue::VOBJ);
+                output.pushKV("txid", key.txhash.GetHex());
+                output.pushKV("outputIndex", int(key.index));
+                output.pushKV("script", HexStr(value.script));
+                output.pushKV("satoshis", value.satoshis);
+                output.pushKV("height", value.blockHeight);
+                result.push_back(output);
+            } else {
+                entries << key.txhash << uint32_t(key.index) << value.satoshis << value.script << int32_t(value.blockHeight);
+            }
+            if (++count == limit) {
+                next = EncodeAddressCursor(key);
+                return false;
+            }
+            return true;
+        });
+    } else if (query == "txids" || query == "deltas") {
+        const bool txids{query == "txids"};
+        std::optional<CAddressIndexKey> after;
+        if (!DecodeAddressCursor(cursor, hash, type, after)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor");
+        }
+        // The entries of one transaction are adjacent in the index, so a page
+        // of txids also skips the rest of the last one of the previous page.
+        std::optional<uint256> last_txid;
+        if (after) last_txid = after->txhash;
+        ok = g_insightindex->ScanAddressIndex(hash, type, after ? &*after : nullptr, start, end, [&](const CAddressIndexKey& key, CAmount value) {
+            if (txids) {
+                if (last_txid == key.txhash) return true;
+                last_txid = key.txhash;
+                if (json) {
+                    result.push_back(key.txhash.GetHex());
+                } else {
+                    entries << key.txhash;
+                }
+            } else if (json) {
+                UniValue delta(UniValue::VOBJ);
+                delta.pushKV("satoshis", value);
+                delta.pushKV("txid", key.txhash.GetHex());
+                delta.pushKV("index", int(key.index));
+                delta.pushKV("spending", key.spending);
+                delta.pushKV("blockindex", int(key.txindex));
+                delta.pushKV("height", key.blockHeight);
+                result.push_back(delta);
+            } else {
+                entries << key.txhash << uint32_t(key.index) << key.spending << value << uint32_t(key.txindex) << int32_t(key.blockHeight);
+            }
+            if (++count == limit) {
+                next = EncodeAddressCursor(key);
+                return false;
+            }
+            return true;
+        });
+    } else if (query == "balance") {
+        CAddressBalanceValue balance;
+        int height;
+        if (!GetAddressBalance(hash, type, balance, height)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+        const CAmount immature{GetImmatureBalance(balance, height)};
+        switch (rf) {
+        case RESTResponseFormat::BINARY:
+        case RESTResponseFormat::HEX: {
+            DataStream ss{};
+            ss << balance.balance << immature << balance.balance - immature << balance.received;
+            if (rf == RESTResponseFormat::HEX) {
+                req->WriteHeader("Content-Type", "text/plain");
+                req->WriteReply(HTTP_OK, HexStr(ss) + "\n");
+            } else {
+                req->WriteHeader("Content-Type", "application/octet-stream");
+                req->WriteReply(HTTP_OK, ss);
+            }
+            return true;
+        }
+        default: {
+            UniValue resp(UniValue::VOBJ);
+            resp.pushKV("balance", balance.balance);
+            resp.pushKV("balance_immature", immature);
+            resp.pushKV("balance_spendable", balance.balance - immature);
+            resp.pushKV("received", balance.received);
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, resp.write() + "\n");
+            return true;
+        }
+        }
+    } else {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid query: " + SanitizeString(query) + " (available: utxos, txids, deltas, balance)");
+    }
+    if (!ok) {
+        return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+    }
+
+    return WriteIndexReply(req, rf, count, entries, query, result, next);
+}
+
+/**
+ * Spending input of an output: /rest/spent/<txid>/<n>.<ext>, looked up in
+ * the mempool first and then in the spent index.
+ */
+static bool rest_spent(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    const std::vector<std::string> path{SplitString(param, '/')};
+    uint256 txid;
+    uint32_t output_index;
+    if (path.size() != 2 || !ParseHashStr(path[0], txid) || !ParseUInt32(path[1], &output_index)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/spent/<txid>/<n>.<ext>");
+    }
+    if (!fSpentIndex || !g_insightindex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    }
+
+    const NodeContext* const node = GetNodeContext(context, req);
+    if (!node) return false;
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    CSpentIndexValue value;
+    if (!GetSpentIndex(*maybe_chainman, CSpentIndexKey(txid, output_index), value, node->mempool.get())) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Unable to get spent info");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        DataStream ss{};
+        ss << value.txid << uint32_t(value.inputIndex) << int32_t(value.blockHeight);
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ss);
+        return true;
+    }
+    case RESTResponseFormat::HEX: {
+        DataStream ss{};
+        ss << value.txid << uint32_t(value.inputIndex) << int32_t(value.blockHeight);
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, HexStr(ss) + "\n");
+        return true;
+    }
+    case RESTResponseFormat::JSON: {
+        UniValue resp(UniValue::VOBJ);
+        resp.pushKV("txid", value.txid.GetHex());
+        resp.pushKV("index", int(value.inputIndex));
+        resp.pushKV("height", value.blockHeight);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, resp.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1017,6 +1413,9 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/addressdeltas/", rest_address_deltas},
+      {"/rest/address/", rest_address},
+      {"/rest/spent/", rest_spent},
 };
 
 void StartREST(const std::any& context)
@@ -1029,6 +1428,7 @@ void StartREST(const std::any& context)
 
 void InterruptREST()
 {
+    if (g_address_notifier) g_address_notifier->Interrupt();
 }
 
 void StopREST()
@@ -229,7 +229,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getaddressdeltas", 1, "start" },
     { "getaddressdeltas", 2, "end" },
     { "getaddressdeltas", 3, "chainInfo" },
+    { "getaddressdeltas", 4, "limit" },
     { "getaddressesbalance", 0, "addresses"},
+    { "watchaddresses", 0, "addresses"},
+    { "unwatchaddresses", 0, "addresses"},
 };
 // clang-format on
 
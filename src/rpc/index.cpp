@@ -3,6 +3,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <rpc/index.h>
+
+#include <addressnotifier.h>
+#include <index/insightindex.h>
 #include <node/context.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
@@ -13,12 +17,16 @@
 #include <validation.h>
 #include <uint256.h>
 #include <key_io.h>
+#include <streams.h>
+#include <util/strencodings.h>
 
 #include <stdint.h>
 
 #include <condition_variable>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 using node::NodeContext;
 
@@ -54,7 +62,7 @@ bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &addr
     return true;
 }
 
-static bool getIndexKey(const std::string& str, uint256& hashBytes, int& type)
+bool getIndexKey(const std::string& str, uint256& hashBytes, int& type)
 {
     CTxDestination dest = DecodeDestination(str);
     if (!IsValidDestination(dest)) {
@@ -96,6 +104,25 @@ static bool getIndexKey(const std::string& str, uint256& hashBytes, int& type)
     return false;
 }
 
+UniValue AddressDeltaEventToJSON(const AddressDeltaEvent& event)
+{
+    std::string address;
+    if (!getAddressFromIndex(event.type, event.address_hash, address)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+    }
+
+    UniValue delta(UniValue::VOBJ);
+    delta.pushKV("sequence", event.sequence);
+    delta.pushKV("status", event.status == AddressDeltaEvent::MEMPOOL ? "mempool" :
+                           event.status == AddressDeltaEvent::CONNECTED ? "connected" : "disconnected");
+    delta.pushKV("address", address);
+    delta.pushKV("txid", event.txid.GetHex());
+    delta.pushKV("index", int(event.index));
+    delta.pushKV("satoshis", event.satoshis);
+    delta.pushKV("height", event.height);
+    return delta;
+}
+
 static bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint256, int> > &addresses)
 {
     if (params[0].isStr()) {
@@ -132,82 +159,248 @@ static bool getAddressesFromParams(const UniValue& params, std::vector<std::pair
 
 bool GetSpentIndex(ChainstateManager &chainman, const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool)
 {
-    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
-    if (!fSpentIndex) {
+    if (!fSpentIndex || !g_insightindex) {
         return false;
     }
     if (pmempool && pmempool->getSpentIndex(key, value)) {
         return true;
     }
-    if (!pblocktree->ReadSpentIndex(key, value)) {
+    g_insightindex->BlockUntilSyncedToCurrentChain();
+    if (!g_insightindex->ReadSpentIndex(key, value)) {
         return false;
     }
 
     return true;
 };
 
-bool GetAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, int type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start = 0, int end = 0)
+/** Resume point of a paginated address query: the position in the address
+ *  list and the last index key returned for that address. */
+template <typename Key>
+struct AddressPageCursor {
+    uint32_t address_pos{0};
+    std::optional<Key> last_key;
+};
+
+template <typename Key>
+static std::string EncodeAddressCursor(uint32_t address_pos, const Key& key)
 {
-    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
+    DataStream ss{};
+    ss << address_pos << key;
+    return HexStr(ss);
+}
 
-    if (!fAddressIndex) {
-        return error("Address index not enabled");
+/**
+ * Read the "limit" and "cursor" fields of an address query. Returns
+ * std::nullopt when no limit was given, in which case the legacy unpaginated
+ * result is returned.
+ */
+template <typename Key>
+static std::optional<size_t> ParseAddressPaging(const UniValue& params, const std::vector<std::pair<uint256, int>>& addresses,
+                                                AddressPageCursor<Key>& cursor)
+{
+    if (!params[0].isObject()) return std::nullopt;
+
+    const UniValue& limitValue = find_value(params[0].get_obj(), "limit");
+    const UniValue& cursorValue = find_value(params[0].get_obj(), "cursor");
+    if (limitValue.isNull()) {
+        if (!cursorValue.isNull()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "cursor requires limit");
+        }
+        return std::nullopt;
+    }
+    const int64_t limit{limitValue.getInt<int64_t>()};
+    if (limit <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "limit is expected to be greater than zero");
+    }
+
+    if (!cursorValue.isNull()) {
+        const std::string& hex{cursorValue.get_str()};
+        if (!IsHex(hex)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        DataStream ss{ParseHex(hex)};
+        Key key;
+        try {
+            ss >> cursor.address_pos >> key;
+        } catch (const std::ios_base::failure&) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        // A cursor is only valid for the address list it was returned for.
+        if (!ss.empty() || cursor.address_pos >= addresses.size() ||
+            key.hashBytes != addresses[cursor.address_pos].first ||
+            key.type != (unsigned int)addresses[cursor.address_pos].second) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        cursor.last_key = key;
     }
+    return size_t(limit);
+}
 
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
-        return error("Unable to get txids for address");
+/**
+ * Stream the index entries of the given addresses into `emit`, in address order
+ * and key order within an address, starting after the cursor. Entries are read
+ * straight from the index iterator, so only the page being built is held in
+ * memory. `emit` returns whether the entry was added to the page.
+ *
+ * Returns the cursor of the next page, or std::nullopt once all entries were
+ * returned.
+ */
+template <typename Key, typename Value, typename Scan, typename Emit>
+static std::optional<std::string> ScanAddressPage(const std::vector<std::pair<uint256, int>>& addresses, const AddressPageCursor<Key>& cursor,
+                                size_t limit, Scan scan, Emit emit)
+{
+    size_t count{0};
+    std::optional<std::string> next;
+    for (uint32_t pos = cursor.address_pos; pos < addresses.size() && !next; ++pos) {
+        const Key* after{pos == cursor.address_pos && cursor.last_key ? &*cursor.last_key : nullptr};
+        const bool ok{scan(addresses[pos].first, addresses[pos].second, after, [&](const Key& key, const Value& value) {
+            if (emit(key, value) && ++count == limit) {
+                next = EncodeAddressCursor(pos, key);
+                return false;
+            }
+            return true;
+        })};
+        if (!ok) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
     }
+    return next;
+}
 
-    return true;
-};
+static const InsightIndex& GetSyncedAddressIndex()
+{
+    if (!fAddressIndex || !g_insightindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
+    }
+    if (!g_insightindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because the address index is still syncing. Current height: %d", g_insightindex->GetSummary().best_block_height));
+    }
+    return *g_insightindex;
+}
 
+/**
+ * The block a snapshot of the address index is up to date with. Results read
+ * from the snapshot report it as their chain tip, so tip and entries always
+ * agree without taking cs_main.
+ */
+static interfaces::BlockKey GetSnapshotTip(const InsightIndex& index, const CDBSnapshot& snapshot)
+{
+    interfaces::BlockKey tip;
+    if (!index.ReadBestBlock(tip, &snapshot)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the best block of the address index");
+    }
+    return tip;
+}
 
-bool GetAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+/**
+ * Read the index entries of several addresses from a snapshot, one scan per
+ * address spread over the index reader threads. Entries are returned grouped
+ * by address, in the order of `addresses`.
+ */
+template <typename Key, typename Value, typename Scan>
+static std::vector<std::pair<Key, Value>> ScanAddresses(const InsightIndex& index, const CDBSnapshot& snapshot,
+                                                        const std::vector<std::pair<uint256, int>>& addresses, Scan scan)
 {
-    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
-    if (!fAddressIndex) {
+    std::vector<std::vector<std::pair<Key, Value>>> results(addresses.size());
+    const bool ok{index.ReadBatch(snapshot, addresses.size(), [&](size_t pos, const CDBSnapshot& snapshot) {
+        return scan(addresses[pos].first, addresses[pos].second, snapshot, [&results, pos](const Key& key, const Value& value) {
+            results[pos].emplace_back(key, value);
+            return true;
+        });
+    })};
+    if (!ok) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    }
+
+    size_t count{0};
+    for (const auto& result : results) count += result.size();
+    std::vector<std::pair<Key, Value>> entries;
+    entries.reserve(count);
+    for (auto& result : results) {
+        entries.insert(entries.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+    }
+    return entries;
+}
+
+bool GetAddressBalance(const uint256& addressHash, int type, CAddressBalanceValue& balance, int& height)
+{
+    if (!fAddressIndex || !g_insightindex) {
         return error("Address index not enabled");
     }
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
-        return error("Unable to get txids for address");
+    if (!g_insightindex->BlockUntilSyncedToCurrentChain()) {
+        return error("Address index is still syncing");
     }
+    const auto snapshot{g_insightindex->TakeSnapshot()};
+    interfaces::BlockKey tip;
+    if (!g_insightindex->ReadBestBlock(tip, snapshot.get())) {
+        return error("Unable to read the best block of the address index");
+    }
+    if (!g_insightindex->ReadAddressBalance(addressHash, type, balance, snapshot.get())) {
+        // no confirmed activity
+        balance.SetNull();
+    }
+    height = tip.height;
 
     return true;
 };
 
-static bool HashOnchainActive(ChainstateManager &chainman, const uint256 &hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+CAmount GetImmatureBalance(const CAddressBalanceValue& balance, int height)
+{
+    CAmount immature{0};
+    for (const auto& [coinbase_height, amount] : balance.recentCoinbase) {
+        if (height - coinbase_height < COINBASE_MATURITY) {
+            immature += amount;
+        }
+    }
+    return immature;
+}
+
+/** Sum the maintained balance records of the given addresses. */
+static UniValue GetAddressesBalance(const std::vector<std::pair<uint256, int>>& addresses)
 {
-    CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+    const InsightIndex& index{GetSyncedAddressIndex()};
+    const auto snapshot{index.TakeSnapshot()};
+    std::vector<CAddressBalanceValue> balances(addresses.size());
+    index.ReadBatch(*snapshot, addresses.size(), [&](size_t pos, const CDBSnapshot& snapshot) {
+        if (!index.ReadAddressBalance(addresses[pos].first, addresses[pos].second, balances[pos], &snapshot)) {
+            // no confirmed activity
+            balances[pos].SetNull();
+        }
+        return true;
+    });
 
-    if (!chainman.ActiveChain().Contains(pblockindex)) {
-        return false;
+    // Coinbase maturity is judged at the height the balances are up to date with.
+    const int nHeight{GetSnapshotTip(index, *snapshot).height};
+
+    CAmount balance = 0;
+    CAmount balance_immature = 0;
+    CAmount received = 0;
+
+    for (const CAddressBalanceValue& value : balances) {
+        balance += value.balance;
+        received += value.received;
+        balance_immature += GetImmatureBalance(value, nHeight);
     }
 
-    return true;
-};
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("balance", balance);
+    result.pushKV("balance_immature", balance_immature);
+    result.pushKV("balance_spendable", balance - balance_immature);
+    result.pushKV("received", received);
+
+    return result;
+}
 
 bool GetTimestampIndex(ChainstateManager &chainman, const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
 {
-    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
-    if (!fTimestampIndex) {
+    if (!fTimestampIndex || !g_insightindex) {
         return error("Timestamp index not enabled");
     }
-    if (!pblocktree->ReadTimestampIndex(high, low, hashes)) {
+    g_insightindex->BlockUntilSyncedToCurrentChain();
+    if (!g_insightindex->ReadTimestampIndex(high, low, fActiveOnly, hashes)) {
         return error("Unable to get hashes for timestamps");
     }
 
-    if (fActiveOnly) {
-        for (auto it = hashes.begin(); it != hashes.end(); ) {
-            if (!HashOnchainActive(chainman, it->first)) {
-                it = hashes.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-
     return true;
 };
 
@@ -237,42 +430,7 @@ static RPCHelpMan getaddressbalance()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address 7");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    ChainstateManager& chainman = EnsureAnyChainman(request.context);
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex(chainman, (*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
-    int nHeight = (unsigned int) chainman.ActiveChain().Height();
-
-    CAmount balance = 0;
-    CAmount balance_spendable = 0;
-    CAmount balance_immature = 0;
-    CAmount received = 0;
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
-        }
-        if (it->first.txindex == 0 && nHeight - it->first.blockHeight < COINBASE_MATURITY) {
-            balance_immature += it->second;
-        } else {
-            balance_spendable += it->second;
-        }
-        balance += it->second;
-    }
-
-    UniValue result(UniValue::VOBJ);
-    result.pushKV("balance", balance);
-    result.pushKV("balance_immature", balance_immature);
-    result.pushKV("balance_spendable", balance_spendable);
-    result.pushKV("received", received);
-
-    return result;
+    return GetAddressesBalance(addresses);
 },
     };
 }
@@ -308,42 +466,7 @@ static RPCHelpMan getaddressesbalance()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address 7");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    ChainstateManager& chainman = EnsureAnyChainman(request.context);
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex(chainman, (*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
-    int nHeight = (unsigned int) chainman.ActiveChain().Height();
-
-    CAmount balance = 0;
-    CAmount balance_spendable = 0;
-    CAmount balance_immature = 0;
-    CAmount received = 0;
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
-        }
-        if (it->first.txindex == 0 && nHeight - it->first.blockHeight < COINBASE_MATURITY) {
-            balance_immature += it->second;
-        } else {
-            balance_spendable += it->second;
-        }
-        balance += it->second;
-    }
-
-    UniValue result(UniValue::VOBJ);
-    result.pushKV("balance", balance);
-    result.pushKV("balance_immature", balance_immature);
-    result.pushKV("balance_spendable", balance_spendable);
-    result.pushKV("received", received);
-
-    return result;
+    return GetAddressesBalance(addresses);
 },
     };
 }
@@ -360,6 +483,8 @@ return RPCHelpMan{"getaddressutxos",
                         },
                     RPCArgOptions{.skip_type_check = true}},
                     {"chainInfo", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include chain info in results, only applies if start and end specified."},
+                    {"limit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "Return at most this many outputs, in index order, together with a cursor for the next page."},
+                    {"cursor", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The cursor returned by the previous page. Requires limit."},
                 },
                 {
                     RPCResult{"Default",
@@ -382,6 +507,16 @@ return RPCHelpMan{"getaddressutxos",
                                 {RPCResult::Type::ELISION, "", "Same as Default"},
                             }}
                         }}
+                    }},
+                    RPCResult{"With limit", RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::ARR, "utxos", "", {
+                            {RPCResult::Type::OBJ, "", "", {
+                                {RPCResult::Type::ELISION, "", "Same as Default"},
+                            }}
+                        }},
+                        {RPCResult::Type::STR_HEX, "cursor", /*optional=*/true, "Cursor of the next page, omitted after the last page"},
+                        {RPCResult::Type::STR_HEX, "hash", /*optional=*/true, "Chain tip hash, with chainInfo"},
+                        {RPCResult::Type::NUM, "height", /*optional=*/true, "Chain height, with chainInfo"},
                     }}
                 },
                 RPCExamples{
@@ -391,8 +526,6 @@ return RPCHelpMan{"getaddressutxos",
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    ChainstateManager &chainman = EnsureAnyChainman(request.context);
-
     if (!fAddressIndex) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
@@ -410,40 +543,61 @@ return RPCHelpMan{"getaddressutxos",
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent(chainman, it->first, it->second, unspentOutputs)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
-
     UniValue utxos(UniValue::VARR);
-
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
+    const auto push_utxo = [&utxos](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
         UniValue output(UniValue::VOBJ);
         std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+        if (!getAddressFromIndex(key.type, key.hashBytes, address)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
 
         output.pushKV("address", address);
-        output.pushKV("txid", it->first.txhash.GetHex());
-        output.pushKV("outputIndex", int(it->first.index));
-        output.pushKV("script", HexStr(it->second.script));
-        output.pushKV("satoshis", it->second.satoshis);
-        output.pushKV("height", it->second.blockHeight);
+        output.pushKV("txid", key.txhash.GetHex());
+        output.pushKV("outputIndex", int(key.index));
+        output.pushKV("script", HexStr(value.script));
+        output.pushKV("satoshis", value.satoshis);
+        output.pushKV("height", value.blockHeight);
         utxos.push_back(output);
+        return true;
+    };
+
+    const InsightIndex& index{GetSyncedAddressIndex()};
+    const auto snapshot{index.TakeSnapshot()};
+    const interfaces::BlockKey tip{GetSnapshotTip(index, *snapshot)};
+
+    AddressPageCursor<CAddressUnspentKey> cursor;
+    if (const auto limit{ParseAddressPaging(request.params, addresses, cursor)}) {
+        const auto next{ScanAddressPage<CAddressUnspentKey, CAddressUnspentValue>(addresses, cursor, *limit,
+            [&](const uint256& hash, int type, const CAddressUnspentKey* after, const auto& visit) {
+                return index.ScanAddressUnspentIndex(hash, type, after, visit, snapshot.get());
+            }, push_utxo)};
+
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("utxos", utxos);
+        if (next) result.pushKV("cursor", *next);
+        if (includeChainInfo) {
+            result.pushKV("hash", tip.hash.GetHex());
+            result.pushKV("height", tip.height);
+        }
+        return result;
+    }
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs{ScanAddresses<CAddressUnspentKey, CAddressUnspentValue>(index, *snapshot, addresses,
+        [&](const uint256& hash, int type, const CDBSnapshot& snapshot, const auto& visit) {
+            return index.ScanAddressUnspentIndex(hash, type, /*after=*/nullptr, visit, &snapshot);
+        })};
+
+    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+
+    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
+        push_utxo(it->first, it->second);
     }
 
     if (includeChainInfo) {
         UniValue result(UniValue::VOBJ);
         result.pushKV("utxos", utxos);
-
-        LOCK(cs_main);
-        result.pushKV("hash", chainman.ActiveChain().Tip()->GetBlockHash().GetHex());
-        result.pushKV("height", int(chainman.ActiveChain().Height()));
+        result.pushKV("hash", tip.hash.GetHex());
+        result.pushKV("height", tip.height);
         return result;
     } else {
         return utxos;
@@ -466,6 +620,8 @@ static RPCHelpMan getaddressdeltas()
                     {"start", RPCArg::Type::NUM, RPCArg::Default{0}, "The start block height."},
                     {"end", RPCArg::Type::NUM, RPCArg::Default{0}, "The end block height."},
                     {"chainInfo", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include chain info in results, only applies if start and end specified."},
+                    {"limit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "Return at most this many deltas, in index order, together with a cursor for the next page."},
+                    {"cursor", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The cursor returned by the previous page. Requires limit."},
                 },
                 {
                     RPCResult{"Default",
@@ -494,6 +650,15 @@ static RPCHelpMan getaddressdeltas()
                             {RPCResult::Type::STR_HEX, "hash", "End hash"},
                             {RPCResult::Type::NUM, "height", "End height"},
                         }},
+                    }},
+                    RPCResult{"With limit", RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::ARR, "deltas", "", {
+                            {RPCResult::Type::OBJ, "", "", {
+                                {RPCResult::Type::ELISION, "", "Same output as Default output"},
+                            }}
+                        }},
+                        {RPCResult::Type::STR_HEX, "cursor", /*optional=*/true, "Cursor of the next page, omitted after the last page"},
+                        {RPCResult::Type::ELISION, "", "start and end as with chainInfo"},
                     }}
                 },
                 RPCExamples{
@@ -537,49 +702,61 @@ static RPCHelpMan getaddressdeltas()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        }
-    }
-
     UniValue deltas(UniValue::VARR);
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+    const auto push_delta = [&deltas](const CAddressIndexKey& key, CAmount value) {
         std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+        if (!getAddressFromIndex(key.type, key.hashBytes, address)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
 
         UniValue delta(UniValue::VOBJ);
-        delta.pushKV("satoshis", it->second);
-        delta.pushKV("txid", it->first.txhash.GetHex());
-        delta.pushKV("index", int(it->first.index));
-        delta.pushKV("blockindex", int(it->first.txindex));
-        delta.pushKV("height", it->first.blockHeight);
+        delta.pushKV("satoshis", value);
+        delta.pushKV("txid", key.txhash.GetHex());
+        delta.pushKV("index", int(key.index));
+        delta.pushKV("blockindex", int(key.txindex));
+        delta.pushKV("height", key.blockHeight);
         delta.pushKV("address", address);
         deltas.push_back(delta);
-    }
+        return true;
+    };
 
     UniValue result(UniValue::VOBJ);
 
+    const InsightIndex& index{GetSyncedAddressIndex()};
+    const auto snapshot{index.TakeSnapshot()};
+
+    AddressPageCursor<CAddressIndexKey> cursor;
+    const auto limit{ParseAddressPaging(request.params, addresses, cursor)};
+    std::optional<std::string> next;
+    if (limit) {
+        next = ScanAddressPage<CAddressIndexKey, CAmount>(addresses, cursor, *limit,
+            [&](const uint256& hash, int type, const CAddressIndexKey* after, const auto& visit) {
+                return index.ScanAddressIndex(hash, type, after, start, end, visit, snapshot.get());
+            }, push_delta);
+    } else {
+        const std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex{ScanAddresses<CAddressIndexKey, CAmount>(index, *snapshot, addresses,
+            [&](const uint256& hash, int type, const CDBSnapshot& snapshot, const auto& visit) {
+                return index.ScanAddressIndex(hash, type, /*after=*/nullptr, start, end, visit, &snapshot);
+            })};
+
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+            push_delta(it->first, it->second);
+        }
+    }
+
     if (includeChainInfo && start > 0 && end > 0) {
-        LOCK(cs_main);
-        const int tip_height = chainman.ActiveChain().Height();
-        if (start > tip_height || end > tip_height) {
+        // Report the blocks of the chain the snapshot is up to date with.
+        const interfaces::BlockKey tip{GetSnapshotTip(index, *snapshot)};
+        if (start > tip.height || end > tip.height) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start or end is outside chain range");
         }
 
-        CBlockIndex* startIndex = chainman.ActiveChain()[start];
-        CBlockIndex* endIndex = chainman.ActiveChain()[end];
+        const CBlockIndex* tipIndex{WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(tip.hash))};
+        if (!tipIndex) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Best block of the address index not found");
+        }
+        const CBlockIndex* startIndex = tipIndex->GetAncestor(start);
+        const CBlockIndex* endIndex = tipIndex->GetAncestor(end);
 
         UniValue startInfo(UniValue::VOBJ);
         UniValue endInfo(UniValue::VOBJ);
@@ -591,9 +768,14 @@ static RPCHelpMan getaddressdeltas()
         endInfo.pushKV("height", end);
 
         result.pushKV("deltas", deltas);
+        if (next) result.pushKV("cursor", *next);
         result.pushKV("start", startInfo);
         result.pushKV("end", endInfo);
 
+        return result;
+    } else if (limit) {
+        result.pushKV("deltas", deltas);
+        if (next) result.pushKV("cursor", *next);
         return result;
     } else {
         return deltas;
@@ -615,11 +797,21 @@ static RPCHelpMan getaddresstxids()
                     RPCArgOptions{.skip_type_check = true}},
                     {"start", RPCArg::Type::NUM, RPCArg::Default{0}, "The start block height."},
                     {"end", RPCArg::Type::NUM, RPCArg::Default{0}, "The end block height."},
+                    {"limit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "Return at most this many txids, per address in index order, together with a cursor for the next page."},
+                    {"cursor", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The cursor returned by the previous page. Requires limit."},
                 },
-                RPCResult{
-                    RPCResult::Type::ARR, "", "", {
-                        {RPCResult::Type::STR_HEX, "transactionid", "The transaction txid"},
-                    }
+                {
+                    RPCResult{"Default",
+                        RPCResult::Type::ARR, "", "", {
+                            {RPCResult::Type::STR_HEX, "transactionid", "The transaction txid"},
+                        }
+                    },
+                    RPCResult{"With limit", RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::ARR, "txids", "", {
+                            {RPCResult::Type::STR_HEX, "transactionid", "The transaction txid"},
+                        }},
+                        {RPCResult::Type::STR_HEX, "cursor", /*optional=*/true, "Cursor of the next page, omitted after the last page"},
+                    }}
                 },
                 RPCExamples{
             HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
@@ -631,8 +823,6 @@ static RPCHelpMan getaddresstxids()
     if (!fAddressIndex) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
-    ChainstateManager &chainman = EnsureAnyChainman(request.context);
-
     std::vector<std::pair<uint256, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
@@ -650,20 +840,41 @@ static RPCHelpMan getaddresstxids()
         }
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    const InsightIndex& index{GetSyncedAddressIndex()};
+    const auto snapshot{index.TakeSnapshot()};
+
+    AddressPageCursor<CAddressIndexKey> cursor;
+    if (const auto limit{ParseAddressPaging(request.params, addresses, cursor)}) {
+        // The entries of one transaction are adjacent in the index, so
+        // comparing with the previous entry is enough to return each txid once
+        // per address, also across a page boundary.
+        std::optional<uint256> last_txid;
+        if (cursor.last_key) last_txid = cursor.last_key->txhash;
+        UniValue txids(UniValue::VARR);
+        const auto next{ScanAddressPage<CAddressIndexKey, CAmount>(addresses, cursor, *limit,
+            [&](const uint256& hash, int type, const CAddressIndexKey* after, const auto& visit) {
+                if (!after) last_txid.reset();
+                return index.ScanAddressIndex(hash, type, after, start, end, visit, snapshot.get());
+            },
+            [&](const CAddressIndexKey& key, CAmount) {
+                if (last_txid == key.txhash) return false;
+                last_txid = key.txhash;
+                txids.push_back(key.txhash.GetHex());
+                return true;
+            })};
 
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        }
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("txids", txids);
+        if (next) result.pushKV("cursor", *next);
+        return result;
     }
 
+    const bool bounded{start > 0 && end > 0};
+    const std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex{ScanAddresses<CAddressIndexKey, CAmount>(index, *snapshot, addresses,
+        [&](const uint256& hash, int type, const CDBSnapshot& snapshot, const auto& visit) {
+            return index.ScanAddressIndex(hash, type, /*after=*/nullptr, bounded ? start : 0, bounded ? end : 0, visit, &snapshot);
+        })};
+
     std::set<std::pair<int, std::string> > txids;
     UniValue result(UniValue::VARR);
 
@@ -748,11 +959,8 @@ static RPCHelpMan getblockhashes()
 
     std::vector<std::pair<uint256, unsigned int> > blockHashes;
 
-    {
-        LOCK(cs_main);
-        if (!GetTimestampIndex(chainman, high, low, fActiveOnly, blockHashes)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for block hashes");
-        }
+    if (!GetTimestampIndex(chainman, high, low, fActiveOnly, blockHashes)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for block hashes");
     }
 
     UniValue result(UniValue::VARR);
@@ -910,6 +1118,93 @@ static RPCHelpMan getspentinfo()
     };
 }
 
+static AddressDeltaNotifier& EnsureAddressNotifier()
+{
+    if (!g_address_notifier) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
+    }
+    return *g_address_notifier;
+}
+
+static UniValue AddressWatchResult(const AddressDeltaNotifier& notifier)
+{
+    std::vector<AddressDeltaEvent> events;
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("watched", uint64_t(notifier.WatchedCount()));
+    result.pushKV("sequence", notifier.GetEvents(std::numeric_limits<uint64_t>::max(), 0, events));
+    return result;
+}
+
+static const RPCResult address_watch_result{
+    RPCResult::Type::OBJ, "", "", {
+        {RPCResult::Type::NUM, "watched", "The number of watched addresses"},
+        {RPCResult::Type::NUM, "sequence", "The sequence number of the last address delta event, to start reading events from"},
+    }
+};
+
+static RPCHelpMan watchaddresses()
+{
+    return RPCHelpMan{"watchaddresses",
+                "\nStarts pushing the deltas of addresses to the -zmqpubaddressdelta publishers and /rest/addressdeltas/ (requires addressindex to be enabled).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
+                        },
+                    RPCArgOptions{.skip_type_check = true}},
+                },
+                address_watch_result,
+                RPCExamples{
+            HelpExampleCli("watchaddresses", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("watchaddresses", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    AddressDeltaNotifier& notifier{EnsureAddressNotifier()};
+
+    std::vector<std::pair<uint256, int> > addresses;
+    getAddressesFromParams(request.params, addresses);
+    for (const auto& [hash, type] : addresses) {
+        notifier.Watch(type, hash);
+    }
+
+    return AddressWatchResult(notifier);
+},
+    };
+}
+
+static RPCHelpMan unwatchaddresses()
+{
+    return RPCHelpMan{"unwatchaddresses",
+                "\nStops pushing the deltas of addresses registered with watchaddresses.\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
+                        },
+                    RPCArgOptions{.skip_type_check = true}},
+                },
+                address_watch_result,
+                RPCExamples{
+            HelpExampleCli("unwatchaddresses", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("unwatchaddresses", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    AddressDeltaNotifier& notifier{EnsureAddressNotifier()};
+
+    std::vector<std::pair<uint256, int> > addresses;
+    getAddressesFromParams(request.params, addresses);
+    for (const auto& [hash, type] : addresses) {
+        notifier.Unwatch(type, hash);
+    }
+
+    return AddressWatchResult(notifier);
+},
+    };
+}
 
 void RegisterIndexRPCCommands(CRPCTable& t)
 {
@@ -923,6 +1218,8 @@ void RegisterIndexRPCCommands(CRPCTable& t)
         {"getaddresstxids",   &getaddresstxids},
         {"getblockhashes",    &getblockhashes},
         {"getspentinfo",      &getspentinfo},
+        {"watchaddresses",    &watchaddresses},
+        {"unwatchaddresses",  &unwatchaddresses},
     };
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
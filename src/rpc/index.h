@@ -0,0 +1,36 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_INDEX_H
+#define BITCOIN_RPC_INDEX_H
+
+#include <consensus/amount.h>
+#include <uint256.h>
+
+#include <string>
+
+struct AddressDeltaEvent;
+struct CAddressBalanceValue;
+class ChainstateManager;
+struct CSpentIndexKey;
+struct CSpentIndexValue;
+class CTxMemPool;
+class UniValue;
+
+/** Address type and hash of an address, as the insight index stores them. */
+bool getIndexKey(const std::string& str, uint256& hashBytes, int& type);
+/** Address of an address type and hash of the insight index. */
+bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address);
+
+/** Look up the spending input of an output, in the mempool first if one is given. */
+bool GetSpentIndex(ChainstateManager& chainman, const CSpentIndexKey& key, CSpentIndexValue& value, const CTxMemPool* pmempool);
+/** Read the balance record of an address, a null record if it has no confirmed
+ *  activity, and the chain height the record is up to date with. */
+bool GetAddressBalance(const uint256& addressHash, int type, CAddressBalanceValue& balance, int& height);
+/** Coinbase amount of a balance record that is still immature at chain height `height`. */
+CAmount GetImmatureBalance(const CAddressBalanceValue& balance, int height);
+
+UniValue AddressDeltaEventToJSON(const AddressDeltaEvent& event);
+
+#endif // BITCOIN_RPC_INDEX_H
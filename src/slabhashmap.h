@@ -0,0 +1,334 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SLABHASHMAP_H
+#define BITCOIN_SLABHASHMAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * A hash map for many small entries, used as the coins cache (CCoinsMap).
+ *
+ * Entries are stored in slabs of SLAB_ENTRIES, so adding entries allocates
+ * memory once per slab instead of once per entry, and entries never move:
+ * like those of std::unordered_map, references and iterators to an entry stay
+ * valid until it is erased. The storage of erased entries is reused.
+ *
+ * Entries are found through an open addressing table with linear probing,
+ * whose slots hold the index of an entry and the upper 32 bits of the hash of
+ * its key (the tag). The home slot of an entry is given by the top bits of its
+ * tag, so probing rarely compares the keys of other entries and growing the
+ * table needs no hashing. Erasing shifts the following slots back instead of
+ * leaving tombstones.
+ *
+ * Iteration is in storage order, and erasing an entry while iterating doesn't
+ * affect the other iterators. Only the part of the std::unordered_map
+ * interface the coins cache needs is provided.
+ */
+template <typename Key, typename T, typename Hash>
+class SlabHashMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using hasher = Hash;
+
+    static constexpr size_t SLAB_ENTRIES{64};
+
+    struct Slab {
+        //! Bit i is set when entry i holds a value
+        uint64_t live{0};
+        //! Erased entries hold the index of the next erased entry instead
+        alignas(value_type) alignas(uint32_t) unsigned char entries[SLAB_ENTRIES][sizeof(value_type)];
+
+        // Leave the entries uninitialized
+        Slab() {}
+    };
+
+    struct Slot {
+        uint32_t tag;
+        uint32_t index;
+    };
+
+private:
+    static constexpr uint32_t NO_ENTRY{std::numeric_limits<uint32_t>::max()};
+    static constexpr int MIN_TABLE_BITS{4};
+
+    Hash m_hash;
+    //! Empty until the first insertion, then 2^m_bits slots
+    std::vector<Slot> m_table;
+    int m_bits{0};
+    std::vector<std::unique_ptr<Slab>> m_slabs;
+    size_t m_size{0};
+    //! Entries from this index on were never handed out
+    uint32_t m_used{0};
+    //! Most recently erased entry, or NO_ENTRY
+    uint32_t m_free{NO_ENTRY};
+
+    static uint32_t Tag(size_t hash)
+    {
+        return static_cast<uint32_t>(uint64_t{hash} >> (sizeof(size_t) > 4 ? 32 : 0));
+    }
+
+    static size_t Home(uint32_t tag, int bits) { return tag >> (32 - bits); }
+
+    size_t Mask() const { return m_table.size() - 1; }
+
+    void* Storage(uint32_t index) const { return m_slabs[index / SLAB_ENTRIES]->entries[index % SLAB_ENTRIES]; }
+
+    value_type& Entry(uint32_t index) const { return *std::launder(reinterpret_cast<value_type*>(Storage(index))); }
+
+    uint64_t& Live(uint32_t index) const { return m_slabs[index / SLAB_ENTRIES]->live; }
+
+    static uint64_t Bit(uint32_t index) { return uint64_t{1} << (index % SLAB_ENTRIES); }
+
+    //! The first entry holding a value from index on, or NO_ENTRY
+    uint32_t NextLive(uint32_t index) const
+    {
+        while (index < m_used) {
+            const uint64_t live{Live(index) >> (index % SLAB_ENTRIES)};
+            if (live & 1) return index;
+            index = live ? index + 1 : (index / SLAB_ENTRIES + 1) * SLAB_ENTRIES;
+        }
+        return NO_ENTRY;
+    }
+
+    uint32_t Allocate()
+    {
+        if (m_free != NO_ENTRY) {
+            const uint32_t index{m_free};
+            std::memcpy(&m_free, Storage(index), sizeof(m_free));
+            return index;
+        }
+        if (m_used == m_slabs.size() * SLAB_ENTRIES) {
+            assert(m_used < NO_ENTRY - SLAB_ENTRIES);
+            m_slabs.push_back(std::make_unique<Slab>());
+        }
+        return m_used++;
+    }
+
+    void Release(uint32_t index)
+    {
+        std::memcpy(Storage(index), &m_free, sizeof(m_free));
+        m_free = index;
+    }
+
+    //! The slot of the entry with key and tag, or of the empty slot ending its probe sequence
+    size_t Probe(const Key& key, uint32_t tag) const
+    {
+        size_t pos{Home(tag, m_bits)};
+        while (m_table[pos].index != NO_ENTRY && (m_table[pos].tag != tag || !(Entry(m_table[pos].index).first == key))) {
+            pos = (pos + 1) & Mask();
+        }
+        return pos;
+    }
+
+    void Rehash(int bits)
+    {
+        assert(bits <= 32);
+        std::vector<Slot> table(size_t{1} << bits, Slot{0, NO_ENTRY});
+        for (const Slot& slot : m_table) {
+            if (slot.index == NO_ENTRY) continue;
+            size_t pos{Home(slot.tag, bits)};
+            while (table[pos].index != NO_ENTRY) {
+                pos = (pos + 1) & (table.size() - 1);
+            }
+            table[pos] = slot;
+        }
+        m_table.swap(table);
+        m_bits = bits;
+    }
+
+    //! Grow the table, if needed, to hold count entries at no more than 3/4 load
+    void Reserve(size_t count)
+    {
+        int bits{std::max(m_bits, MIN_TABLE_BITS)};
+        while (count > (size_t{3} << bits) / 4) ++bits;
+        if (bits != m_bits) Rehash(bits);
+    }
+
+    void Destroy(uint32_t index)
+    {
+        Entry(index).~value_type();
+        Live(index) &= ~Bit(index);
+        Release(index);
+    }
+
+    template <bool IS_CONST>
+    class Iterator
+    {
+        friend class SlabHashMap;
+        friend class Iterator<!IS_CONST>;
+        using Map = std::conditional_t<IS_CONST, const SlabHashMap, SlabHashMap>;
+
+        Map* m_map{nullptr};
+        uint32_t m_index{NO_ENTRY};
+
+        Iterator(Map* map, uint32_t index) : m_map{map}, m_index{index} {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename SlabHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IS_CONST, const value_type*, value_type*>;
+        using reference = std::conditional_t<IS_CONST, const value_type&, value_type&>;
+
+        Iterator() = default;
+        template <bool OTHER_CONST, typename = std::enable_if_t<IS_CONST && !OTHER_CONST>>
+        Iterator(const Iterator<OTHER_CONST>& other) : m_map{other.m_map}, m_index{other.m_index} {}
+
+        reference operator*() const { return m_map->Entry(m_index); }
+        pointer operator->() const { return &m_map->Entry(m_index); }
+
+        Iterator& operator++()
+        {
+            m_index = m_map->NextLive(m_index + 1);
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator copy{*this};
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.m_index == b.m_index; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.m_index != b.m_index; }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit SlabHashMap(size_t bucket_count = 0, const Hash& hash = Hash()) : m_hash{hash}
+    {
+        if (bucket_count > 0) Reserve(bucket_count);
+    }
+
+    SlabHashMap(const SlabHashMap&) = delete;
+    SlabHashMap& operator=(const SlabHashMap&) = delete;
+
+    ~SlabHashMap() { clear(); }
+
+    iterator begin() { return {this, NextLive(0)}; }
+    const_iterator begin() const { return {this, NextLive(0)}; }
+    iterator end() { return {this, NO_ENTRY}; }
+    const_iterator end() const { return {this, NO_ENTRY}; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    //! Number of table slots
+    size_t bucket_count() const { return m_table.size(); }
+    //! Number of slabs, and of slab pointers there is room for
+    size_t slab_count() const { return m_slabs.size(); }
+    size_t slab_capacity() const { return m_slabs.capacity(); }
+
+    iterator find(const Key& key)
+    {
+        if (m_size == 0) return end();
+        const Slot& slot{m_table[Probe(key, Tag(m_hash(key)))]};
+        return {this, slot.index};
+    }
+    const_iterator find(const Key& key) const { return const_cast<SlabHashMap*>(this)->find(key); }
+
+    /** Construct an entry from args, and insert it unless there is one with
+     *  its key already. */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        const uint32_t index{Allocate()};
+        try {
+            ::new (Storage(index)) value_type(std::forward<Args>(args)...);
+        } catch (...) {
+            Release(index);
+            throw;
+        }
+        Live(index) |= Bit(index);
+
+        const Key& key{Entry(index).first};
+        const uint32_t tag{Tag(m_hash(key))};
+        if (m_size > 0) {
+            const Slot& slot{m_table[Probe(key, tag)]};
+            if (slot.index != NO_ENTRY) {
+                Destroy(index);
+                return {{this, slot.index}, false};
+            }
+        }
+        Reserve(m_size + 1);
+        m_table[Probe(key, tag)] = Slot{tag, index};
+        ++m_size;
+        return {{this, index}, true};
+    }
+
+    T& operator[](const Key& key)
+    {
+        iterator it{find(key)};
+        if (it == end()) it = emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+        return it->second;
+    }
+
+    /** Erase an entry. Returns an iterator to the entry following it. */
+    iterator erase(const_iterator it)
+    {
+        const uint32_t index{it.m_index};
+        size_t hole{Home(Tag(m_hash(Entry(index).first)), m_bits)};
+        while (m_table[hole].index != index) {
+            hole = (hole + 1) & Mask();
+        }
+        // Move each following slot of the probe sequence into the hole,
+        // unless that would put it before its home slot.
+        for (size_t pos = (hole + 1) & Mask(); m_table[pos].index != NO_ENTRY; pos = (pos + 1) & Mask()) {
+            const size_t home{Home(m_table[pos].tag, m_bits)};
+            if (((pos - home) & Mask()) >= ((pos - hole) & Mask())) {
+                m_table[hole] = m_table[pos];
+                hole = pos;
+            }
+        }
+        m_table[hole].index = NO_ENTRY;
+
+        Destroy(index);
+        if (--m_size == 0) {
+            // Hand out the storage from the start again.
+            m_used = 0;
+            m_free = NO_ENTRY;
+            return end();
+        }
+        return {this, NextLive(index + 1)};
+    }
+
+    /** Erase all entries, keeping the memory of the table and the slabs. */
+    void clear()
+    {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (uint32_t index = NextLive(0); index != NO_ENTRY; index = NextLive(index + 1)) {
+                Entry(index).~value_type();
+            }
+        }
+        for (auto& slab : m_slabs) {
+            slab->live = 0;
+        }
+        for (Slot& slot : m_table) {
+            slot.index = NO_ENTRY;
+        }
+        m_size = 0;
+        m_used = 0;
+        m_free = NO_ENTRY;
+    }
+};
+
+#endif // BITCOIN_SLABHASHMAP_H
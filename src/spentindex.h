@@ -11,13 +11,94 @@
 #include <script/script.h>
 #include <serialize.h>
 
+#include <ios>
+#include <utility>
+#include <vector>
+
+/**
+ * On-disk encoding of the insight index (format version 2).
+ *
+ * Address hashes are stored with the width of their address type, and the
+ * integer fields of keys are big-endian or OrderedCompactFormatter encoded, so
+ * LevelDB's bytewise key order is the numeric order of the fields and range
+ * seeks by height or timestamp are exact. LegacyIndexFormatter reads the
+ * version 1 encoding, in which earlier versions kept the entries in
+ * blocks/index, for migrating them.
+ */
+
+/** Width of the stored hash of an address type: 20 bytes for key and script
+ *  hashes (ADDR_INDT_PUBKEY_ADDRESS, ADDR_INDT_SCRIPT_ADDRESS and
+ *  ADDR_INDT_WITNESS_V0_KEYHASH), the full 32 bytes for anything else. */
+inline size_t AddressHashSize(unsigned int type)
+{
+    return (type == 1 || type == 2 || type == 5) ? 20 : 32;
+}
+
+template <typename Stream>
+void SerializeAddressHash(Stream& s, unsigned int type, const uint256& hash)
+{
+    s.write(MakeByteSpan(hash).first(AddressHashSize(type)));
+}
+
+template <typename Stream>
+void UnserializeAddressHash(Stream& s, unsigned int type, uint256& hash)
+{
+    hash.SetNull();
+    s.read(MakeWritableByteSpan(hash).first(AddressHashSize(type)));
+}
+
+/**
+ * Variable length encoding of a 32-bit unsigned integer whose byte strings
+ * sort like the numbers they encode (VARINT does not): 1 byte below 2^7,
+ * 2 bytes below 2^14, 3 bytes below 2^21 and 5 bytes otherwise. The length
+ * class is in the leading bits of the first byte.
+ */
+struct OrderedCompactFormatter
+{
+    template <typename Stream, typename I>
+    void Ser(Stream& s, I v)
+    {
+        const uint32_t n{static_cast<uint32_t>(v)};
+        if (n < 0x80) {
+            ser_writedata8(s, n);
+        } else if (n < 0x4000) {
+            ser_writedata16be(s, 0x8000 | n);
+        } else if (n < 0x200000) {
+            ser_writedata8(s, 0xC0 | (n >> 16));
+            ser_writedata16be(s, n & 0xFFFF);
+        } else {
+            ser_writedata8(s, 0xE0);
+            ser_writedata32be(s, n);
+        }
+    }
+
+    template <typename Stream, typename I>
+    void Unser(Stream& s, I& v)
+    {
+        const uint8_t first{ser_readdata8(s)};
+        uint32_t n;
+        if (first < 0x80) {
+            n = first;
+        } else if (first < 0xC0) {
+            n = (uint32_t(first & 0x3F) << 8) | ser_readdata8(s);
+        } else if (first < 0xE0) {
+            n = (uint32_t(first & 0x1F) << 16) | ser_readdata16be(s);
+        } else if (first == 0xE0) {
+            n = ser_readdata32be(s);
+        } else {
+            throw std::ios_base::failure("invalid ordered compact integer");
+        }
+        v = static_cast<I>(n);
+    }
+};
+
 struct CSpentIndexKey {
     uint256 txid;
     unsigned int outputIndex;
 
     SERIALIZE_METHODS(CSpentIndexKey, obj)
     {
-        READWRITE(obj.txid, obj.outputIndex);
+        READWRITE(obj.txid, Using<OrderedCompactFormatter>(obj.outputIndex));
     }
 
     CSpentIndexKey(uint256 t, unsigned int i) {
@@ -44,9 +125,20 @@ struct CSpentIndexValue {
     int addressType;
     uint256 addressHash;
 
-    SERIALIZE_METHODS(CSpentIndexValue, obj)
+    template <typename Stream>
+    void Serialize(Stream& s) const
     {
-        READWRITE(obj.txid, obj.inputIndex, obj.blockHeight, obj.satoshis, obj.addressType, obj.addressHash);
+        s << txid << VARINT(inputIndex) << VARINT_MODE(blockHeight, VarIntMode::NONNEGATIVE_SIGNED)
+          << VARINT_MODE(satoshis, VarIntMode::NONNEGATIVE_SIGNED) << VARINT_MODE(addressType, VarIntMode::NONNEGATIVE_SIGNED);
+        SerializeAddressHash(s, addressType, addressHash);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> txid >> VARINT(inputIndex) >> VARINT_MODE(blockHeight, VarIntMode::NONNEGATIVE_SIGNED)
+          >> VARINT_MODE(satoshis, VarIntMode::NONNEGATIVE_SIGNED) >> VARINT_MODE(addressType, VarIntMode::NONNEGATIVE_SIGNED);
+        UnserializeAddressHash(s, addressType, addressHash);
     }
 
     CSpentIndexValue(uint256 t, unsigned int i, int h, CAmount s, int type, uint256 a) {
@@ -95,7 +187,7 @@ struct CSpentIndexTxInfo
 struct CTimestampIndexIteratorKey {
     unsigned int timestamp;
 
-    SERIALIZE_METHODS(CTimestampIndexIteratorKey, obj) { READWRITE(obj.timestamp); }
+    SERIALIZE_METHODS(CTimestampIndexIteratorKey, obj) { READWRITE(Using<BigEndianFormatter<4>>(obj.timestamp)); }
 
     CTimestampIndexIteratorKey(unsigned int time) {
         timestamp = time;
@@ -114,7 +206,7 @@ struct CTimestampIndexKey {
     unsigned int timestamp;
     uint256 blockHash;
 
-    SERIALIZE_METHODS(CTimestampIndexKey, obj) { READWRITE(obj.timestamp, obj.blockHash); }
+    SERIALIZE_METHODS(CTimestampIndexKey, obj) { READWRITE(Using<BigEndianFormatter<4>>(obj.timestamp), obj.blockHash); }
 
     CTimestampIndexKey(unsigned int time, uint256 hash) {
         timestamp = time;
@@ -137,8 +229,20 @@ struct CAddressUnspentKey {
     uint256 txhash;
     unsigned int index;
 
-    SERIALIZE_METHODS(CAddressUnspentKey, obj) {
-        READWRITE(obj.type, obj.hashBytes, obj.txhash, obj.index);
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        SerializeAddressHash(s, type, hashBytes);
+        s << txhash << Using<OrderedCompactFormatter>(index);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        type = ser_readdata8(s);
+        UnserializeAddressHash(s, type, hashBytes);
+        s >> txhash >> Using<OrderedCompactFormatter>(index);
     }
 
     CAddressUnspentKey(unsigned int addressType, uint256 addressHash, uint256 txid, unsigned int indexValue) {
@@ -158,6 +262,10 @@ struct CAddressUnspentKey {
         txhash.SetNull();
         index = 0;
     }
+
+    friend bool operator==(const CAddressUnspentKey& a, const CAddressUnspentKey& b) {
+        return a.type == b.type && a.hashBytes == b.hashBytes && a.txhash == b.txhash && a.index == b.index;
+    }
 };
 
 struct CAddressUnspentValue {
@@ -200,7 +308,23 @@ struct CAddressIndexKey {
     unsigned int index;
     bool spending;
 
-    SERIALIZE_METHODS(CAddressIndexKey, obj) {READWRITE(obj.type, obj.hashBytes, obj.blockHeight, obj.txindex, obj.txhash, obj.index, obj.spending);}
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        SerializeAddressHash(s, type, hashBytes);
+        ser_writedata32be(s, blockHeight);
+        s << Using<OrderedCompactFormatter>(txindex) << txhash << Using<OrderedCompactFormatter>(index) << spending;
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        type = ser_readdata8(s);
+        UnserializeAddressHash(s, type, hashBytes);
+        blockHeight = ser_readdata32be(s);
+        s >> Using<OrderedCompactFormatter>(txindex) >> txhash >> Using<OrderedCompactFormatter>(index) >> spending;
+    }
 
     CAddressIndexKey(unsigned int addressType, uint256 addressHash, int height, int blockindex,
                      uint256 txid, unsigned int indexValue, bool isSpending) {
@@ -227,13 +351,29 @@ struct CAddressIndexKey {
         spending = false;
     }
 
+    friend bool operator==(const CAddressIndexKey& a, const CAddressIndexKey& b) {
+        return a.type == b.type && a.hashBytes == b.hashBytes && a.blockHeight == b.blockHeight &&
+               a.txindex == b.txindex && a.txhash == b.txhash && a.index == b.index && a.spending == b.spending;
+    }
 };
 
 struct CAddressIndexIteratorKey {
     unsigned int type;
     uint256 hashBytes;
 
-    SERIALIZE_METHODS(CAddressIndexIteratorKey, obj) {READWRITE(obj.type, obj.hashBytes);}
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        SerializeAddressHash(s, type, hashBytes);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        type = ser_readdata8(s);
+        UnserializeAddressHash(s, type, hashBytes);
+    }
 
     CAddressIndexIteratorKey(unsigned int addressType, uint256 addressHash) {
         type = addressType;
@@ -255,7 +395,13 @@ struct CAddressIndexIteratorHeightKey {
     uint256 hashBytes;
     int blockHeight;
 
-    SERIALIZE_METHODS(CAddressIndexIteratorHeightKey, obj) {READWRITE(obj.type, obj.hashBytes, obj.blockHeight);}
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        SerializeAddressHash(s, type, hashBytes);
+        ser_writedata32be(s, blockHeight);
+    }
 
     CAddressIndexIteratorHeightKey(unsigned int addressType, uint256 addressHash, int height) {
         type = addressType;
@@ -274,5 +420,75 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+    uint64_t txCount;
+    int lastHeight;
+    // coinbase outputs received in recent blocks, which may still be immature
+    std::vector<std::pair<int, CAmount>> recentCoinbase;
+
+    SERIALIZE_METHODS(CAddressBalanceValue, obj)
+    {
+        READWRITE(obj.balance, obj.received, obj.txCount, obj.lastHeight, obj.recentCoinbase);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        txCount = 0;
+        lastHeight = 0;
+        recentCoinbase.clear();
+    }
+
+    bool IsNull() const {
+        return txCount == 0;
+    }
+};
+
+/** Version 1 encoding of the index entries in blocks/index: full 32-byte
+ *  address hashes and fixed width little-endian integers. Types whose encoding
+ *  did not change are passed through. */
+struct LegacyIndexFormatter
+{
+    template <typename Stream, typename T>
+    void Ser(Stream& s, const T& obj) { s << obj; }
+    template <typename Stream, typename T>
+    void Unser(Stream& s, T& obj) { s >> obj; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CAddressIndexKey& k) { s << k.type << k.hashBytes << k.blockHeight << k.txindex << k.txhash << k.index << k.spending; }
+    template <typename Stream>
+    void Unser(Stream& s, CAddressIndexKey& k) { s >> k.type >> k.hashBytes >> k.blockHeight >> k.txindex >> k.txhash >> k.index >> k.spending; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CAddressUnspentKey& k) { s << k.type << k.hashBytes << k.txhash << k.index; }
+    template <typename Stream>
+    void Unser(Stream& s, CAddressUnspentKey& k) { s >> k.type >> k.hashBytes >> k.txhash >> k.index; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CAddressIndexIteratorKey& k) { s << k.type << k.hashBytes; }
+    template <typename Stream>
+    void Unser(Stream& s, CAddressIndexIteratorKey& k) { s >> k.type >> k.hashBytes; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CSpentIndexKey& k) { s << k.txid << k.outputIndex; }
+    template <typename Stream>
+    void Unser(Stream& s, CSpentIndexKey& k) { s >> k.txid >> k.outputIndex; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CSpentIndexValue& v) { s << v.txid << v.inputIndex << v.blockHeight << v.satoshis << v.addressType << v.addressHash; }
+    template <typename Stream>
+    void Unser(Stream& s, CSpentIndexValue& v) { s >> v.txid >> v.inputIndex >> v.blockHeight >> v.satoshis >> v.addressType >> v.addressHash; }
+
+    template <typename Stream>
+    void Ser(Stream& s, const CTimestampIndexKey& k) { s << k.timestamp << k.blockHash; }
+    template <typename Stream>
+    void Unser(Stream& s, CTimestampIndexKey& k) { s >> k.timestamp >> k.blockHash; }
+};
 
 #endif // BITCOIN_SPENTINDEX_H
@@ -175,6 +175,15 @@ public:
         memcpy(dst.data(), m_data.data(), dst.size());
         m_data = m_data.subspan(dst.size());
     }
+
+    /* YespowerSugar */
+    void ignore(size_t num_ignore)
+    {
+        if (num_ignore > m_data.size()) {
+            throw std::ios_base::failure("SpanReader::ignore(): end of data");
+        }
+        m_data = m_data.subspan(num_ignore);
+    }
 };
 
 /** Double ended buffer combining vector and stream-like interfaces.
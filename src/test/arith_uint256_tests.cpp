@@ -360,6 +360,14 @@ BOOST_AUTO_TEST_CASE( divide )
     BOOST_CHECK(R2L / MaxL == ZeroL);
     BOOST_CHECK(MaxL / R2L == 1);
     BOOST_CHECK_THROW(R2L / ZeroL, uint_error);
+    // Divisors of a single word take the short division path.
+    BOOST_CHECK(R1L / 0x10000 == (R1L >> 16));
+    BOOST_CHECK(MaxL / 0x80000000 == (MaxL >> 31));
+    for (const uint32_t d : {3U, 510U, 2550U, 0xfffffffbU}) {
+        const arith_uint256 q{R2L / d};
+        BOOST_CHECK(R2L - q * d < d);
+        BOOST_CHECK(q * d <= R2L);
+    }
 }
 
 
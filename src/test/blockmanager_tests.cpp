@@ -3,17 +3,31 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chainparams.h>
+#include <consensus/validation.h>
+#include <node/blockfilemaps.h>
+#include <node/blockprefetch.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <script/script.h>
+#include <undo.h>
+#include <util/strencodings.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 #include <test/util/setup_common.h>
 
+using node::BlockFileMapCache;
 using node::BlockManager;
+using node::BlockPrefetcher;
+using node::GetBlockFileMaps;
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
 using node::MAX_BLOCKFILE_SIZE;
 using node::OpenBlockFile;
+using node::PoWHashCache;
+using node::RawBlock;
+using node::ReadBlockFromDisk;
+using node::ReadRawBlockFromDisk;
+using node::UndoReadFromDisk;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and cleanup
 BOOST_FIXTURE_TEST_SUITE(blockmanager_tests, BasicTestingSetup)
@@ -41,6 +55,79 @@ BOOST_AUTO_TEST_CASE(blockmanager_find_block_pos)
     BOOST_CHECK_EQUAL(actual.nPos, BLOCK_SERIALIZATION_HEADER_SIZE + ::GetSerializeSize(params->GenesisBlock(), CLIENT_VERSION) + BLOCK_SERIALIZATION_HEADER_SIZE);
 }
 
+BOOST_AUTO_TEST_CASE(blocktree_pow_hash_roundtrip)
+{
+    const auto params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    CBlockTreeDB block_tree{DBParams{.path = m_args.GetDataDirNet() / "blocks" / "index", .cache_bytes = 1 << 20, .memory_only = true}};
+
+    // The genesis entry is written with its PoW hash, the second one as an
+    // older version would have written it.
+    const CBlock& genesis{params->GenesisBlock()};
+    const uint256 genesis_pow_hash{genesis.GetPoWHash()};
+    const uint256 genesis_hash{genesis.GetHash()};
+    CBlockIndex genesis_index{genesis};
+    genesis_index.phashBlock = &genesis_hash;
+
+    CBlockHeader child{genesis.GetBlockHeader()};
+    child.hashPrevBlock = genesis_hash;
+    const uint256 child_hash{child.GetHash()};
+    CBlockIndex child_index{child};
+    child_index.phashBlock = &child_hash;
+    child_index.pprev = &genesis_index;
+    child_index.nHeight = 1;
+    BOOST_CHECK(block_tree.WriteBatchSync({}, 0, {&genesis_index, &child_index}, {{genesis_hash, genesis_pow_hash}}));
+
+    std::map<uint256, CBlockIndex> loaded;
+    const auto insert{[&](const uint256& hash) -> CBlockIndex* {
+        if (hash.IsNull()) return nullptr;
+        CBlockIndex& index{loaded[hash]};
+        index.phashBlock = &loaded.find(hash)->first;
+        return &index;
+    }};
+    std::vector<CBlockIndex*> missing_pow_hash;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(block_tree.LoadBlockIndexGuts(params->GetConsensus(), insert, missing_pow_hash));
+    }
+    BOOST_CHECK_EQUAL(loaded.at(genesis_hash).GetBlockPoWHash(), genesis_pow_hash);
+    BOOST_REQUIRE_EQUAL(missing_pow_hash.size(), 1U);
+    BOOST_CHECK_EQUAL(missing_pow_hash[0]->GetBlockHash(), child_hash);
+
+    // A stored PoW hash that does not meet the target is rejected on load.
+    BOOST_CHECK(block_tree.WritePoWHashes({{child_hash, uint256S(std::string(64, 'f'))}}));
+    loaded.clear();
+    missing_pow_hash.clear();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!block_tree.LoadBlockIndexGuts(params->GetConsensus(), insert, missing_pow_hash));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pow_hash_cache_lru)
+{
+    PoWHashCache cache{2};
+    const uint256 a{uint256S("a")}, b{uint256S("b")}, c{uint256S("c")};
+    cache.Insert(a, uint256::ONE);
+    cache.Insert(b, uint256::ONE);
+    // Looking up a makes b the least recently used entry.
+    BOOST_CHECK(cache.Get(a) == uint256::ONE);
+    cache.Insert(c, uint256::ONE);
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    BOOST_CHECK(cache.Contains(a));
+    BOOST_CHECK(!cache.Contains(b));
+    BOOST_CHECK(!cache.Get(b));
+    BOOST_CHECK(cache.Contains(c));
+
+    cache.Insert(c, uint256::ZERO);
+    BOOST_CHECK(cache.Get(c) == uint256::ZERO);
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    BOOST_CHECK(cache.DynamicMemoryUsage() > 0);
+
+    PoWHashCache disabled{0};
+    disabled.Insert(a, uint256::ONE);
+    BOOST_CHECK_EQUAL(disabled.Size(), 0U);
+}
+
 BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
@@ -82,4 +169,162 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain
     BOOST_CHECK(!AutoFile(OpenBlockFile(new_pos, true)).IsNull());
 }
 
+BOOST_AUTO_TEST_CASE(blockfile_map_cache)
+{
+    const fs::path dir{m_args.GetDataDirNet()};
+    const auto write{[&](const fs::path& path, size_t size) {
+        AutoFile file{fsbridge::fopen(path, "ab")};
+        const std::vector<uint8_t> bytes(size, 0x42);
+        file.write(MakeByteSpan(bytes));
+    }};
+    const fs::path a{dir / "a.dat"}, b{dir / "b.dat"}, c{dir / "c.dat"};
+    write(a, 100);
+    write(b, 100);
+    write(c, 100);
+
+    BlockFileMapCache cache{2};
+    const auto mapped_a{cache.Get(a, 100)};
+    BOOST_REQUIRE(mapped_a);
+    BOOST_CHECK_EQUAL(mapped_a->Bytes().size(), 100U);
+    BOOST_CHECK_EQUAL(mapped_a->Bytes()[99], 0x42);
+    BOOST_CHECK_EQUAL(cache.Get(a, 50), mapped_a);
+    // Past the end of the file
+    BOOST_CHECK(!cache.Get(a, 101));
+    BOOST_CHECK(!cache.Get(dir / "missing.dat", 1));
+
+    // The file is mapped again once it grew, while the old mapping stays
+    // readable.
+    write(a, 100);
+    const auto grown_a{cache.Get(a, 200)};
+    BOOST_REQUIRE(grown_a);
+    BOOST_CHECK(grown_a != mapped_a);
+    BOOST_CHECK_EQUAL(grown_a->Bytes().size(), 200U);
+    BOOST_CHECK_EQUAL(mapped_a->Bytes()[0], 0x42);
+
+    // The least recently used file is unmapped first.
+    BOOST_REQUIRE(cache.Get(b, 100));
+    BOOST_CHECK_EQUAL(cache.Get(a, 200), grown_a);
+    BOOST_REQUIRE(cache.Get(c, 100));
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    BOOST_CHECK_EQUAL(cache.Get(a, 200), grown_a);
+
+    cache.Erase(a);
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    BOOST_CHECK(cache.Get(a, 200) != grown_a);
+
+    cache.SetMaxFiles(0);
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK(!cache.Get(a, 200));
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_read_mapped_block)
+{
+    const auto params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const CBlock& genesis{params->GenesisBlock()};
+    CDataStream expected{SER_DISK, CLIENT_VERSION};
+    expected << genesis;
+
+    CBlockUndo undo;
+    undo.vtxundo.emplace_back();
+    undo.vtxundo.back().vprevout.emplace_back(CTxOut{5000, CScript{} << OP_TRUE}, /*nHeightIn=*/1, /*fCoinBaseIn=*/false);
+    CDataStream expected_undo{SER_DISK, CLIENT_VERSION};
+    expected_undo << undo;
+
+    // Blocks and undo data read the same from the mapping of their file and
+    // through a FILE*.
+    for (const int64_t max_mapped_files : {int64_t{64}, int64_t{0}}) {
+        // Start without the mappings of earlier tests.
+        GetBlockFileMaps().SetMaxFiles(0);
+        BlockManager blockman{{.max_mapped_files = max_mapped_files}};
+        const size_t mapped{max_mapped_files > 0 ? 1U : 0U};
+        CChain chain{};
+        const FlatFilePos pos{blockman.SaveBlockToDisk(genesis, 0, chain, *params, nullptr)};
+        BOOST_REQUIRE(!pos.IsNull());
+        BOOST_CHECK_EQUAL(GetBlockFileMaps().Size(), 0U);
+
+        CBlock block;
+        BOOST_CHECK(ReadBlockFromDisk(block, pos, params->GetConsensus()));
+        BOOST_CHECK_EQUAL(block.GetHash(), genesis.GetHash());
+        // The blk file is mapped.
+        BOOST_CHECK_EQUAL(GetBlockFileMaps().Size(), mapped);
+
+        RawBlock raw;
+        BOOST_CHECK(ReadRawBlockFromDisk(raw, pos, params->MessageStart()));
+        BOOST_CHECK(raw.owner);
+        BOOST_CHECK(std::equal(raw.data.begin(), raw.data.end(), UCharCast(expected.data()), UCharCast(expected.data() + expected.size())));
+
+        CMessageHeader::MessageStartChars wrong_start;
+        memcpy(wrong_start, params->MessageStart(), sizeof(wrong_start));
+        wrong_start[0] ^= 0xff;
+        BOOST_CHECK(!ReadRawBlockFromDisk(raw, pos, wrong_start));
+
+        // Undo data of a block on top of the genesis block, stored in the rev
+        // file next to the blk file.
+        const uint256 genesis_hash{genesis.GetHash()};
+        CBlockIndex genesis_index{genesis};
+        genesis_index.phashBlock = &genesis_hash;
+        CBlockIndex index{};
+        index.pprev = &genesis_index;
+        index.nHeight = 1;
+        index.nFile = pos.nFile;
+        {
+            LOCK(cs_main);
+            BlockValidationState state;
+            BOOST_REQUIRE(blockman.WriteUndoDataForBlock(undo, state, &index, *params));
+        }
+        CBlockUndo read_undo;
+        BOOST_CHECK(UndoReadFromDisk(read_undo, &index));
+        CDataStream read_undo_data{SER_DISK, CLIENT_VERSION};
+        read_undo_data << read_undo;
+        BOOST_CHECK_EQUAL(HexStr(read_undo_data), HexStr(expected_undo));
+        // The rev file is mapped as well.
+        BOOST_CHECK_EQUAL(GetBlockFileMaps().Size(), 2 * mapped);
+
+        // A block whose undo data does not match its parent fails the checksum.
+        const uint256 other_hash{uint256::ONE};
+        genesis_index.phashBlock = &other_hash;
+        BOOST_CHECK(!UndoReadFromDisk(read_undo, &index));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_prefetcher)
+{
+    const auto params{CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const CBlock& genesis{params->GenesisBlock()};
+    BlockManager blockman{{}};
+    CChain chain{};
+    const FlatFilePos pos{blockman.SaveBlockToDisk(genesis, 0, chain, *params, nullptr)};
+    BOOST_REQUIRE(!pos.IsNull());
+
+    const uint256 other{uint256::ONE};
+    {
+        BlockPrefetcher prefetcher{params->GetConsensus(), /*depth=*/2, /*threads=*/2};
+        BOOST_CHECK(prefetcher.Prefetch(genesis.GetHash(), pos));
+        BOOST_CHECK(prefetcher.Prefetch(genesis.GetHash(), pos));
+        BOOST_CHECK(prefetcher.Prefetch(other, pos));
+        BOOST_CHECK_EQUAL(prefetcher.Size(), 2U);
+        // Full
+        BOOST_CHECK(!prefetcher.Prefetch(uint256::ZERO, pos));
+
+        // Taking the second block drops the first. Its hash does not match
+        // the block at pos, so it cannot be read.
+        BOOST_CHECK(!prefetcher.Take(other));
+        BOOST_CHECK_EQUAL(prefetcher.Size(), 0U);
+    }
+
+    // A block is handed out once read, unless no helper thread got to it.
+    std::atomic<int> checked{0};
+    BlockPrefetcher prefetcher{params->GetConsensus(), /*depth=*/2, /*threads=*/1, [&](const CBlock&) { ++checked; }};
+    BOOST_CHECK(prefetcher.Prefetch(genesis.GetHash(), pos));
+    while (checked == 0) UninterruptibleSleep(1ms);
+    const auto block{prefetcher.Take(genesis.GetHash())};
+    BOOST_REQUIRE(block);
+    BOOST_CHECK_EQUAL(block->GetHash(), genesis.GetHash());
+
+    // A block that was not queued drops the others.
+    BOOST_CHECK(prefetcher.Prefetch(genesis.GetHash(), pos));
+    BOOST_CHECK(!prefetcher.Take(other));
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,6 +14,7 @@
 #include <crypto/sha256.h>
 #include <crypto/sha3.h>
 #include <crypto/sha512.h>
+#include <crypto/yespower.h>
 #include <crypto/muhash.h>
 #include <random.h>
 #include <streams.h>
@@ -21,6 +22,8 @@
 #include <test/util/setup_common.h>
 #include <util/strencodings.h>
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -853,6 +856,89 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+/* YespowerSugar */
+static void TestYespower(yespower_version_t version, uint32_t N, uint32_t r, const char* pers, const std::string& hexout)
+{
+    const yespower_params_t params = {
+        .version = version,
+        .N = N,
+        .r = r,
+        .pers = (const uint8_t*)pers,
+        .perslen = pers ? strlen(pers) : 0,
+    };
+    uint8_t src[80];
+    for (size_t i = 0; i < sizeof(src); ++i) src[i] = i * 3;
+
+    yespower_binary_t tls_out, local_out;
+    BOOST_CHECK_EQUAL(YespowerTLS(src, sizeof(src), &params, &tls_out), 0);
+    yespower_local_t local;
+    yespower_init_local(&local);
+    BOOST_CHECK_EQUAL(Yespower(&local, src, sizeof(src), &params, &local_out), 0);
+    yespower_free_local(&local);
+    BOOST_CHECK_EQUAL(HexStr(tls_out.uc), hexout);
+    BOOST_CHECK_EQUAL(HexStr(local_out.uc), hexout);
+}
+
+// Test vectors from crypto/yespower-1.0.1/TESTS-OK, run against the implementation picked at startup
+BOOST_AUTO_TEST_CASE(yespower_testvectors)
+{
+    BOOST_CHECK(!YespowerAutoDetect().empty());
+    TestYespower(YESPOWER_0_5, 2048, 8, "Client Key", "a59fec4c4fdda16e3b1405adda66d525b68e7cadfcfe6ac066c7ad118cd80590");
+    TestYespower(YESPOWER_0_5, 2048, 32, "Client Key", "560a891b5ca2e1c636111a9ff7c894a5d0a2602f43fdcfa5949b95e22fe4461e");
+    TestYespower(YESPOWER_1_0, 2048, 8, nullptr, "69e0e895b3df7aeeb837d71fe199e9d34f7ec46ecbca7a2c4308e51857ae9b46");
+    TestYespower(YESPOWER_1_0, 2048, 32, nullptr, "d5efb813cd263e9b34540130233cbbc6a921fbff3431e5ec1a1abde2aea6ff4d");
+    TestYespower(YESPOWER_1_0, 1024, 32, "personality test", "1f0269acf565c49adc0ef9b8f26ab3808cdc38394a254fddeedcc3aacff6ad9d");
+}
+
+BOOST_AUTO_TEST_CASE(yespower_context_pool)
+{
+    const yespower_params_t params = {
+        .version = YESPOWER_1_0,
+        .N = 2048,
+        .r = 32,
+        .pers = nullptr,
+        .perslen = 0,
+    };
+    uint8_t src[80];
+    for (size_t i = 0; i < sizeof(src); ++i) src[i] = i * 3;
+    const std::string expected{"d5efb813cd263e9b34540130233cbbc6a921fbff3431e5ec1a1abde2aea6ff4d"};
+
+    // A cap below the size of one context still lets hashing proceed, one at a time.
+    YespowerContextPool pool{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            yespower_binary_t out;
+            if (pool.Hash(src, sizeof(src), params, &out) != 0 || HexStr(out.uc) != expected) ++failures;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    BOOST_CHECK_EQUAL(failures, 0);
+    BOOST_CHECK_EQUAL(pool.Contexts(), 1U);
+    BOOST_CHECK_GE(pool.AllocatedBytes(), YespowerScratchSize(params));
+    BOOST_CHECK_LE(pool.HugePageContexts(), pool.Contexts());
+
+    // Parameters needing less memory reuse the idle context.
+    const yespower_params_t small_params = {
+        .version = YESPOWER_1_0,
+        .N = 1024,
+        .r = 32,
+        .pers = (const uint8_t*)"personality test",
+        .perslen = 16,
+    };
+    BOOST_CHECK_LT(YespowerScratchSize(small_params), YespowerScratchSize(params));
+    yespower_binary_t out;
+    BOOST_CHECK_EQUAL(pool.Hash(src, sizeof(src), small_params, &out), 0);
+    BOOST_CHECK_EQUAL(HexStr(out.uc), "1f0269acf565c49adc0ef9b8f26ab3808cdc38394a254fddeedcc3aacff6ad9d");
+    BOOST_CHECK_EQUAL(pool.Contexts(), 1U);
+
+    // Lowering the cap never frees the last context.
+    pool.SetMaxBytes(0);
+    BOOST_CHECK_EQUAL(pool.MaxBytes(), 0U);
+    BOOST_CHECK_EQUAL(pool.Contexts(), 1U);
+}
+
 static void TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
@@ -200,6 +200,41 @@ BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_snapshot)
+{
+    fs::path ph = m_args.GetDataDirBase() / "dbwrapper_snapshot";
+    CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = true});
+
+    uint8_t key{'j'};
+    uint256 in = InsecureRand256();
+    BOOST_CHECK(dbw.Write(key, in));
+    const CDBSnapshot snapshot{dbw};
+
+    // Writes after the snapshot are not seen through it.
+    uint256 in_new = InsecureRand256();
+    BOOST_CHECK(dbw.Write(key, in_new));
+    uint8_t key2{'k'};
+    BOOST_CHECK(dbw.Write(key2, InsecureRand256()));
+
+    uint256 res;
+    BOOST_CHECK(dbw.Read(key, res, &snapshot));
+    BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+    BOOST_CHECK(dbw.Exists(key2));
+    BOOST_CHECK(!dbw.Read(key2, res, &snapshot));
+    BOOST_CHECK(dbw.Read(key, res));
+    BOOST_CHECK_EQUAL(res.ToString(), in_new.ToString());
+
+    std::unique_ptr<CDBIterator> it(dbw.NewIterator(&snapshot));
+    it->Seek(key);
+    uint8_t key_res;
+    BOOST_REQUIRE(it->GetKey(key_res));
+    BOOST_REQUIRE(it->GetValue(res));
+    BOOST_CHECK_EQUAL(key_res, key);
+    BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+    it->Next();
+    BOOST_CHECK(!it->Valid());
+}
+
 // Test that we do not obfuscation if there is existing data.
 BOOST_AUTO_TEST_CASE(existing_data_no_obfuscate)
 {
@@ -317,6 +352,17 @@ BOOST_AUTO_TEST_CASE(iterator_ordering)
         }
         BOOST_CHECK(!it->Valid());
     }
+
+    // Iterate backwards over the same snapshot
+    it->SeekToLast();
+    for (int x = 0xfe; x >= 0; x -= 2) {
+        uint8_t key;
+        BOOST_REQUIRE(it->Valid());
+        BOOST_CHECK(it->GetKey(key));
+        BOOST_CHECK_EQUAL(key, x);
+        it->Prev();
+    }
+    BOOST_CHECK(!it->Valid());
 }
 
 struct StringContentsSerializer {
@@ -0,0 +1,596 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addressnotifier.h>
+#include <chainparams.h>
+#include <index/externalsort.h>
+#include <index/insightindex.h>
+#include <interfaces/chain.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <util/strencodings.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <tuple>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+template <typename Setup>
+struct InsightIndexSetup : public Setup {
+    InsightIndexSetup() { fAddressIndex = fSpentIndex = fTimestampIndex = true; }
+    ~InsightIndexSetup() { fAddressIndex = fSpentIndex = fTimestampIndex = false; }
+};
+
+std::pair<uint256, int> AddressKey(const CScript& script)
+{
+    std::vector<unsigned char> hash_bytes;
+    int type{0};
+    BOOST_REQUIRE(ExtractIndexInfo(&script, type, hash_bytes));
+    BOOST_REQUIRE(type != 0);
+    return {uint256(hash_bytes.data(), hash_bytes.size()), type};
+}
+
+template <typename T>
+std::string EncodeHex(const T& obj)
+{
+    DataStream ss{};
+    ss << obj;
+    return HexStr(ss);
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(insightindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(insightindex_key_encoding, BasicTestingSetup)
+{
+    // Compact integers sort like the numbers they encode and round trip.
+    std::vector<std::string> encoded;
+    for (const uint32_t n : {0U, 1U, 0x7fU, 0x80U, 0xffU, 0x3fffU, 0x4000U, 0x1fffffU, 0x200000U, 0xffffffffU}) {
+        encoded.push_back(EncodeHex(Using<OrderedCompactFormatter>(n)));
+        DataStream ss{ParseHex(encoded.back())};
+        uint32_t decoded;
+        ss >> Using<OrderedCompactFormatter>(decoded);
+        BOOST_CHECK_EQUAL(decoded, n);
+        BOOST_CHECK(ss.empty());
+    }
+    BOOST_CHECK(std::is_sorted(encoded.begin(), encoded.end()));
+
+    // 20-byte address hashes are stored without padding, and heights sort
+    // numerically.
+    const std::vector<unsigned char> hash_bytes(20, 0xab);
+    const uint256 hash{hash_bytes.data(), hash_bytes.size()};
+    const CAddressIndexKey key_255{1, hash, 255, 3, uint256::ONE, 1, false};
+    const CAddressIndexKey key_256{1, hash, 256, 0, uint256::ONE, 0, true};
+    BOOST_CHECK_EQUAL(GetSerializeSize(key_255, 0), 60U);
+    BOOST_CHECK_EQUAL(GetSerializeSize(Using<LegacyIndexFormatter>(key_255), 0), 81U);
+    BOOST_CHECK(EncodeHex(key_255) < EncodeHex(key_256));
+    BOOST_CHECK(EncodeHex(CAddressIndexIteratorHeightKey(1, hash, 256)) > EncodeHex(key_255));
+
+    DataStream ss{};
+    CAddressIndexKey decoded_key;
+    ss << key_256;
+    ss >> decoded_key;
+    BOOST_CHECK(decoded_key == key_256);
+
+    const CAddressUnspentKey unspent_key{5, hash, uint256::ONE, 300};
+    CAddressUnspentKey decoded_unspent;
+    BOOST_CHECK_EQUAL(GetSerializeSize(unspent_key, 0), 55U);
+    ss << unspent_key;
+    ss >> decoded_unspent;
+    BOOST_CHECK(decoded_unspent == unspent_key);
+
+    // Unknown address types keep the full hash.
+    for (const int type : {1, 0}) {
+        const CSpentIndexValue value{uint256::ONE, 2, 123456, 50 * COIN, type, type ? hash : uint256::ONE};
+        CSpentIndexValue decoded;
+        ss << value;
+        ss >> decoded;
+        BOOST_CHECK(decoded.txid == value.txid);
+        BOOST_CHECK_EQUAL(decoded.inputIndex, value.inputIndex);
+        BOOST_CHECK_EQUAL(decoded.blockHeight, value.blockHeight);
+        BOOST_CHECK_EQUAL(decoded.satoshis, value.satoshis);
+        BOOST_CHECK_EQUAL(decoded.addressType, value.addressType);
+        BOOST_CHECK(decoded.addressHash == value.addressHash);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_address_notifier, BasicTestingSetup)
+{
+    AddressDeltaNotifier notifier{/*max_events=*/3};
+    const uint256 watched{uint256S("aa")};
+    const uint256 other{uint256S("bb")};
+    const auto make_events{[&](int count) {
+        std::vector<AddressDeltaEvent> events;
+        for (int i = 0; i < count; ++i) {
+            events.emplace_back(AddressDeltaEvent::MEMPOOL, 1, watched, uint256::ONE, i, false, COIN, -1);
+            events.emplace_back(AddressDeltaEvent::MEMPOOL, 1, other, uint256::ONE, i, false, COIN, -1);
+        }
+        return events;
+    }};
+
+    // Nothing is logged until an address is watched.
+    BOOST_CHECK(!notifier.IsWatching());
+    notifier.Notify(make_events(1));
+    std::vector<AddressDeltaEvent> events;
+    BOOST_CHECK_EQUAL(notifier.GetEvents(0, 10, events), 0U);
+    BOOST_CHECK(events.empty());
+
+    BOOST_CHECK(notifier.Watch(1, watched));
+    BOOST_CHECK(!notifier.Watch(1, watched));
+    BOOST_CHECK(notifier.Watch(2, watched));
+    BOOST_CHECK(notifier.Unwatch(2, watched));
+    BOOST_CHECK_EQUAL(notifier.WatchedCount(), 1U);
+
+    // Only the events of the watched address are logged, numbered in order.
+    notifier.Notify(make_events(2));
+    BOOST_CHECK_EQUAL(notifier.GetEvents(0, 10, events), 2U);
+    BOOST_REQUIRE_EQUAL(events.size(), 2U);
+    BOOST_CHECK_EQUAL(events[0].sequence, 1U);
+    BOOST_CHECK_EQUAL(events[1].sequence, 2U);
+    BOOST_CHECK(events[1].address_hash == watched);
+    BOOST_CHECK_EQUAL(events[1].index, 1U);
+
+    // Readers continue after the last event they saw, and old events are
+    // dropped once the log is full.
+    notifier.Notify(make_events(3));
+    events.clear();
+    BOOST_CHECK_EQUAL(notifier.GetEvents(2, 1, events), 5U);
+    BOOST_REQUIRE_EQUAL(events.size(), 1U);
+    BOOST_CHECK_EQUAL(events[0].sequence, 3U);
+    events.clear();
+    notifier.GetEvents(0, 10, events);
+    BOOST_REQUIRE_EQUAL(events.size(), 3U);
+    BOOST_CHECK_EQUAL(events.front().sequence, 3U);
+
+    // Waiting readers time out without new events and return at once with them.
+    events.clear();
+    BOOST_CHECK_EQUAL(notifier.WaitForEvents(5, 10, std::chrono::milliseconds{1}, events), 5U);
+    BOOST_CHECK(events.empty());
+    BOOST_CHECK_EQUAL(notifier.WaitForEvents(4, 10, std::chrono::hours{1}, events), 5U);
+    BOOST_CHECK_EQUAL(events.size(), 1U);
+
+    // Events serialize for ZMQ and binary REST replies.
+    DataStream ss{};
+    ss << events[0];
+    AddressDeltaEvent decoded;
+    ss >> decoded;
+    BOOST_CHECK_EQUAL(decoded.sequence, 5U);
+    BOOST_CHECK(decoded.address_hash == watched);
+    BOOST_CHECK_EQUAL(decoded.satoshis, COIN);
+    BOOST_CHECK_EQUAL(decoded.height, -1);
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_sorted_runs, BasicTestingSetup)
+{
+    const fs::path dir{gArgs.GetDataDirNet()};
+    const auto record{[](const std::string& key, uint64_t order, bool erase) {
+        SortedRecord record;
+        record.key.assign(key.begin(), key.end());
+        record.value.assign(1, uint8_t(order));
+        record.order = order;
+        record.erase = erase;
+        return record;
+    }};
+
+    std::vector<SortedRecord> records_1{record("b", 1, false), record("a", 0, false), record("c", 5, true)};
+    std::vector<SortedRecord> records_2{record("c", 2, false), record("b", 3, true), record("ab", 4, false)};
+    BOOST_REQUIRE(WriteSortedRun(dir / "1.run", {{1, 2}}, records_1));
+    BOOST_REQUIRE(WriteSortedRun(dir / "2.run", {{3, 3}, {5, 6}}, records_2));
+    BOOST_CHECK(!fs::exists(dir / "1.run.tmp"));
+
+    std::vector<std::unique_ptr<SortedRunReader>> runs;
+    runs.push_back(std::make_unique<SortedRunReader>(dir / "1.run"));
+    runs.push_back(std::make_unique<SortedRunReader>(dir / "2.run"));
+    BOOST_CHECK(runs[1]->Ranges() == HeightRanges({{3, 3}, {5, 6}}));
+
+    // One record per key in bytewise order, the one with the highest order
+    // winning, erase records included.
+    std::vector<std::tuple<std::string, uint64_t, bool>> merged;
+    BOOST_CHECK(MergeSortedRuns(runs, [&](SortedRecord& record) {
+        merged.emplace_back(std::string(record.key.begin(), record.key.end()), record.order, record.erase);
+        BOOST_CHECK_EQUAL(record.value.at(0), record.order);
+        return true;
+    }));
+    const std::vector<std::tuple<std::string, uint64_t, bool>> expected{{"a", 0, false}, {"ab", 4, false}, {"b", 3, true}, {"c", 5, true}};
+    BOOST_CHECK(merged == expected);
+
+    // A run only shows up once it is committed, and a truncated one is
+    // detected.
+    {
+        SortedRunWriter writer{dir / "3.run", {}};
+        writer.Write(record("d", 0, false));
+    }
+    BOOST_CHECK(!fs::exists(dir / "3.run"));
+    {
+        SortedRunWriter writer{dir / "4.run", {}};
+        writer.Write(record("e", 0, false));
+        BOOST_REQUIRE(writer.Commit());
+    }
+    fs::resize_file(dir / "4.run", fs::file_size(dir / "4.run") - 1);
+    SortedRunReader truncated{dir / "4.run"};
+    SortedRecord next;
+    BOOST_CHECK(truncated.Next(next));
+    BOOST_CHECK_THROW(truncated.Next(next), std::ios_base::failure);
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_migrate_legacy, InsightIndexSetup<TestingSetup>)
+{
+    const std::vector<unsigned char> hash_bytes(20, 0xab);
+    const uint256 hash{hash_bytes.data(), hash_bytes.size()};
+    const uint256 txid_2{uint256S("02")};
+    const CAddressIndexKey key_255{1, hash, 255, 0, uint256::ONE, 0, false};
+    const CAddressIndexKey key_256{1, hash, 256, 1, txid_2, 0, false};
+    const CAddressIndexKey key_257{1, hash, 257, 1, txid_2, 0, true};
+    const CAddressUnspentKey unspent_key{1, hash, uint256::ONE, 0};
+    const CSpentIndexKey spent_key{txid_2, 0};
+    const CSpentIndexValue spent_value{txid_2, 0, 257, COIN, 1, hash};
+
+    // Write the entries as earlier versions kept them in blocks/index.
+    LOCK(cs_main);
+    CBlockTreeDB& block_tree_db{*Assert(m_node.chainman->m_blockman.m_block_tree_db)};
+    const CBlockIndex* tip{m_node.chainman->ActiveChain().Tip()};
+    const auto write_legacy{[&] {
+        CDBBatch batch(block_tree_db);
+        for (const auto& key : {key_255, key_256, key_257}) {
+            batch.Write(std::make_pair(uint8_t{'a'}, Using<LegacyIndexFormatter>(key)), key.spending ? -COIN : COIN);
+        }
+        batch.Write(std::make_pair(uint8_t{'u'}, Using<LegacyIndexFormatter>(unspent_key)), CAddressUnspentValue(COIN, CScript(), 255));
+        batch.Write(std::make_pair(uint8_t{'p'}, Using<LegacyIndexFormatter>(spent_key)), Using<LegacyIndexFormatter>(spent_value));
+        batch.Write(std::make_pair(uint8_t{'s'}, Using<LegacyIndexFormatter>(CTimestampIndexKey(1000, uint256::ONE))), 0);
+        BOOST_REQUIRE(block_tree_db.WriteBatch(batch));
+    }};
+    const auto legacy_entries{[&] {
+        return block_tree_db.Exists(std::make_pair(uint8_t{'a'}, Using<LegacyIndexFormatter>(key_256))) ||
+               block_tree_db.Exists(std::make_pair(uint8_t{'u'}, Using<LegacyIndexFormatter>(unspent_key))) ||
+               block_tree_db.Exists(std::make_pair(uint8_t{'p'}, Using<LegacyIndexFormatter>(spent_key))) ||
+               block_tree_db.Exists(std::make_pair(uint8_t{'s'}, Using<LegacyIndexFormatter>(CTimestampIndexKey(1000, uint256::ONE))));
+    }};
+    write_legacy();
+    for (const std::string flag : {"addressindex", "spentindex", "timestampindex"}) {
+        BOOST_REQUIRE(block_tree_db.WriteFlag(flag, true));
+    }
+
+    InsightIndex index(interfaces::MakeChain(m_node), 1 << 20);
+    BOOST_REQUIRE(index.MigrateLegacyEntries(block_tree_db, tip));
+    BOOST_CHECK(!legacy_entries());
+    bool flag{true};
+    BOOST_CHECK(block_tree_db.ReadFlag("addressindex", flag) && !flag);
+
+    interfaces::BlockKey best_block;
+    BOOST_REQUIRE(index.ReadBestBlock(best_block));
+    BOOST_CHECK(best_block.hash == tip->GetBlockHash());
+
+    // Range reads by height are exact in the migrated index.
+    std::vector<std::pair<CAddressIndexKey, CAmount>> address_index;
+    BOOST_CHECK(index.ReadAddressIndex(hash, 1, address_index, 256, 257));
+    BOOST_REQUIRE_EQUAL(address_index.size(), 2U);
+    BOOST_CHECK(address_index[0].first == key_256);
+    BOOST_CHECK(address_index[1].first == key_257);
+    BOOST_CHECK_EQUAL(address_index[1].second, -COIN);
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent;
+    BOOST_CHECK(index.ReadAddressUnspentIndex(hash, 1, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 1U);
+    BOOST_CHECK(unspent[0].first == unspent_key);
+    BOOST_CHECK_EQUAL(unspent[0].second.blockHeight, 255);
+
+    CSpentIndexValue spent;
+    BOOST_REQUIRE(index.ReadSpentIndex(spent_key, spent));
+    BOOST_CHECK_EQUAL(spent.blockHeight, 257);
+    BOOST_CHECK(spent.addressHash == hash);
+
+    std::vector<std::pair<uint256, unsigned int>> hashes;
+    BOOST_CHECK(index.ReadTimestampIndex(1001, 999, /*active_only=*/false, hashes));
+    BOOST_REQUIRE_EQUAL(hashes.size(), 1U);
+    BOOST_CHECK_EQUAL(hashes[0].second, 1000U);
+
+    // The balance record is folded from the address index entries.
+    CAddressBalanceValue read_balance;
+    BOOST_REQUIRE(index.ReadAddressBalance(hash, 1, read_balance));
+    BOOST_CHECK_EQUAL(read_balance.balance, COIN);
+    BOOST_CHECK_EQUAL(read_balance.received, 2 * COIN);
+    BOOST_CHECK_EQUAL(read_balance.txCount, 2U);
+    BOOST_CHECK_EQUAL(read_balance.lastHeight, 257);
+    BOOST_REQUIRE_EQUAL(read_balance.recentCoinbase.size(), 1U);
+    BOOST_CHECK_EQUAL(read_balance.recentCoinbase[0].first, 255);
+
+    // Entries found once the index is built are only erased.
+    write_legacy();
+    BOOST_REQUIRE(index.MigrateLegacyEntries(block_tree_db, tip));
+    BOOST_CHECK(!legacy_entries());
+    write_legacy();
+    BOOST_REQUIRE(EraseLegacyInsightEntries(block_tree_db));
+    BOOST_CHECK(!legacy_entries());
+
+    // Batches of reads are spread over the reader threads and the caller.
+    StartIndexReadWorkerThreads(3);
+    std::vector<CAmount> balances(64, -1);
+    const auto snapshot{index.TakeSnapshot()};
+    BOOST_CHECK(index.ReadBatch(*snapshot, balances.size(), [&](size_t pos, const CDBSnapshot& snapshot) {
+        CAddressBalanceValue value;
+        if (!index.ReadAddressBalance(hash, 1, value, &snapshot)) return false;
+        balances[pos] = value.balance;
+        return true;
+    }));
+    BOOST_CHECK(std::all_of(balances.begin(), balances.end(), [](CAmount balance) { return balance == COIN; }));
+    BOOST_CHECK(!index.ReadBatch(*snapshot, balances.size(), [&](size_t pos, const CDBSnapshot& snapshot) { return pos != 42; }));
+
+    // A batch that is held up, here on all reader threads, does not hold up
+    // the batches of other callers.
+    std::promise<void> release;
+    const std::shared_future<void> released{release.get_future()};
+    std::atomic<int> held{0};
+    std::thread slow{[&] {
+        index.ReadBatch(*snapshot, 4, [&](size_t pos, const CDBSnapshot& snapshot) {
+            ++held;
+            released.wait();
+            return true;
+        });
+    }};
+    while (held < 4) std::this_thread::yield();
+    BOOST_CHECK(index.ReadBatch(*snapshot, balances.size(), [&](size_t pos, const CDBSnapshot& snapshot) { return true; }));
+    release.set_value();
+    slow.join();
+    StopIndexReadWorkerThreads();
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_sync_and_rewind, InsightIndexSetup<TestChain100Setup>)
+{
+    InsightIndex index(interfaces::MakeChain(m_node), 1 << 20, true);
+
+    const CScript script_a{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const auto [hash_a, type_a] = AddressKey(script_a);
+
+    // Mine one block to an indexable address before the index starts so the
+    // initial sync has to pick it up.
+    const CBlock synced_block{CreateAndProcessBlock({}, script_a)};
+
+    BOOST_REQUIRE(index.Start());
+
+    // Allow the index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        UninterruptibleSleep(std::chrono::milliseconds{100});
+    }
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> address_index;
+    BOOST_CHECK(index.ReadAddressIndex(hash_a, type_a, address_index));
+    BOOST_REQUIRE_EQUAL(address_index.size(), 1U);
+    BOOST_CHECK(address_index[0].first.txhash == synced_block.vtx[0]->GetHash());
+    BOOST_CHECK(!address_index[0].first.spending);
+    BOOST_CHECK_EQUAL(address_index[0].second, synced_block.vtx[0]->vout[0].nValue);
+
+    const CAmount coinbase_value{synced_block.vtx[0]->vout[0].nValue};
+    CAddressBalanceValue balance;
+    BOOST_REQUIRE(index.ReadAddressBalance(hash_a, type_a, balance));
+    BOOST_CHECK_EQUAL(balance.balance, coinbase_value);
+    BOOST_CHECK_EQUAL(balance.received, coinbase_value);
+    BOOST_CHECK_EQUAL(balance.txCount, 1U);
+    BOOST_CHECK_EQUAL(balance.lastHeight, 101);
+    BOOST_REQUIRE_EQUAL(balance.recentCoinbase.size(), 1U);
+    BOOST_CHECK_EQUAL(balance.recentCoinbase[0].first, 101);
+
+    std::vector<std::pair<uint256, unsigned int>> hashes;
+    BOOST_CHECK(index.ReadTimestampIndex(std::numeric_limits<unsigned int>::max(), 0, /*active_only=*/true, hashes));
+    BOOST_CHECK_EQUAL(hashes.size(), 101U); // all blocks but genesis
+    const unsigned int synced_time{synced_block.nTime};
+    hashes.clear();
+    BOOST_CHECK(index.ReadTimestampIndex(synced_time + 1, synced_time, /*active_only=*/false, hashes));
+    BOOST_CHECK(std::any_of(hashes.begin(), hashes.end(), [&](const auto& entry) { return entry.first == synced_block.GetHash(); }));
+    BOOST_CHECK(std::all_of(hashes.begin(), hashes.end(), [&](const auto& entry) { return entry.second == synced_time; }));
+
+    // Connect a block where one transaction spends the output of another, so
+    // the unspent index has to be updated in order.
+    CKey key_b;
+    key_b.MakeNewKey(true);
+    const CScript script_b{GetScriptForDestination(PKHash(key_b.GetPubKey()))};
+    const auto [hash_b, type_b] = AddressKey(script_b);
+
+    const CMutableTransaction tx_1{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, script_a, 1 * COIN, /*submit=*/false)};
+    const CMutableTransaction tx_2{CreateValidMempoolTransaction(MakeTransactionRef(tx_1), 0, 102, coinbaseKey, script_b, COIN / 2, /*submit=*/false)};
+    const CBlock spend_block{CreateAndProcessBlock({tx_1, tx_2}, CScript() << OP_TRUE)};
+    BOOST_REQUIRE_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()), spend_block.GetHash());
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+
+    // The best block marker is written with the entries of the block.
+    interfaces::BlockKey best_block;
+    BOOST_REQUIRE(index.ReadBestBlock(best_block));
+    BOOST_CHECK(best_block.hash == spend_block.GetHash());
+    BOOST_CHECK_EQUAL(best_block.height, 102);
+
+    CSpentIndexValue spent;
+    BOOST_REQUIRE(index.ReadSpentIndex(CSpentIndexKey(tx_1.GetHash(), 0), spent));
+    BOOST_CHECK(spent.txid == tx_2.GetHash());
+    BOOST_CHECK_EQUAL(spent.inputIndex, 0U);
+    BOOST_CHECK_EQUAL(spent.blockHeight, 102);
+    BOOST_CHECK_EQUAL(spent.satoshis, 1 * COIN);
+    BOOST_CHECK(spent.addressHash == hash_a);
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent_a, unspent_b;
+    BOOST_CHECK(index.ReadAddressUnspentIndex(hash_a, type_a, unspent_a));
+    BOOST_REQUIRE_EQUAL(unspent_a.size(), 1U); // tx_1's output is spent again in the same block
+    BOOST_CHECK(unspent_a[0].first.txhash == synced_block.vtx[0]->GetHash());
+    BOOST_CHECK(index.ReadAddressUnspentIndex(hash_b, type_b, unspent_b));
+    BOOST_REQUIRE_EQUAL(unspent_b.size(), 1U);
+    BOOST_CHECK_EQUAL(unspent_b[0].second.satoshis, COIN / 2);
+
+    address_index.clear();
+    BOOST_CHECK(index.ReadAddressIndex(hash_a, type_a, address_index));
+    BOOST_CHECK_EQUAL(address_index.size(), 3U);
+
+    // Resuming a scan after the last visited key pages through the same
+    // entries in the same order.
+    std::vector<CAddressIndexKey> paged;
+    while (true) {
+        const CAddressIndexKey* after{paged.empty() ? nullptr : &paged.back()};
+        std::optional<CAddressIndexKey> next;
+        BOOST_CHECK(index.ScanAddressIndex(hash_a, type_a, after, 0, 0, [&](const CAddressIndexKey& key, CAmount) {
+            next = key;
+            return false;
+        }));
+        if (!next) break;
+        paged.push_back(*next);
+    }
+    BOOST_REQUIRE_EQUAL(paged.size(), address_index.size());
+    for (size_t i = 0; i < paged.size(); ++i) {
+        BOOST_CHECK(paged[i] == address_index[i].first);
+    }
+    size_t unspent_visited{0};
+    BOOST_CHECK(index.ScanAddressUnspentIndex(hash_b, type_b, &unspent_b[0].first, [&](const CAddressUnspentKey&, const CAddressUnspentValue&) {
+        ++unspent_visited;
+        return true;
+    }));
+    BOOST_CHECK_EQUAL(unspent_visited, 0U);
+
+    BOOST_REQUIRE(index.ReadAddressBalance(hash_a, type_a, balance));
+    BOOST_CHECK_EQUAL(balance.balance, coinbase_value);
+    BOOST_CHECK_EQUAL(balance.received, coinbase_value + 1 * COIN);
+    BOOST_CHECK_EQUAL(balance.txCount, 3U);
+    BOOST_CHECK_EQUAL(balance.lastHeight, 102);
+    BOOST_REQUIRE(index.ReadAddressBalance(hash_b, type_b, balance));
+    BOOST_CHECK_EQUAL(balance.balance, COIN / 2);
+    BOOST_CHECK_EQUAL(balance.txCount, 1U);
+    BOOST_CHECK(balance.recentCoinbase.empty());
+
+    // Disconnecting the block must remove everything it added.
+    {
+        BlockValidationState state;
+        CBlockIndex* pindex{WITH_LOCK(cs_main, return m_node.chainman->m_blockman.LookupBlockIndex(spend_block.GetHash()))};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, pindex));
+    }
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(index.ReadBestBlock(best_block));
+    BOOST_CHECK(best_block.hash == synced_block.GetHash());
+    BOOST_CHECK_EQUAL(best_block.height, 101);
+    BOOST_CHECK(!index.ReadSpentIndex(CSpentIndexKey(tx_1.GetHash(), 0), spent));
+    unspent_a.clear();
+    unspent_b.clear();
+    BOOST_CHECK(index.ReadAddressUnspentIndex(hash_a, type_a, unspent_a));
+    BOOST_CHECK_EQUAL(unspent_a.size(), 1U);
+    BOOST_CHECK(index.ReadAddressUnspentIndex(hash_b, type_b, unspent_b));
+    BOOST_CHECK(unspent_b.empty());
+    address_index.clear();
+    BOOST_CHECK(index.ReadAddressIndex(hash_a, type_a, address_index));
+    BOOST_CHECK_EQUAL(address_index.size(), 1U);
+
+    BOOST_REQUIRE(index.ReadAddressBalance(hash_a, type_a, balance));
+    BOOST_CHECK_EQUAL(balance.balance, coinbase_value);
+    BOOST_CHECK_EQUAL(balance.received, coinbase_value);
+    BOOST_CHECK_EQUAL(balance.txCount, 1U);
+    BOOST_CHECK_EQUAL(balance.lastHeight, 101);
+    BOOST_CHECK_EQUAL(balance.recentCoinbase.size(), 1U);
+    BOOST_CHECK(!index.ReadAddressBalance(hash_b, type_b, balance));
+
+    // The disconnected block is only found when stale blocks are included.
+    const auto has_spend_block{[&](const auto& entries) {
+        return std::any_of(entries.begin(), entries.end(), [&](const auto& entry) { return entry.first == spend_block.GetHash(); });
+    }};
+    hashes.clear();
+    BOOST_CHECK(index.ReadTimestampIndex(std::numeric_limits<unsigned int>::max(), 0, /*active_only=*/true, hashes));
+    BOOST_CHECK_EQUAL(hashes.size(), 101U);
+    BOOST_CHECK(!has_spend_block(hashes));
+    hashes.clear();
+    BOOST_CHECK(index.ReadTimestampIndex(std::numeric_limits<unsigned int>::max(), 0, /*active_only=*/false, hashes));
+    BOOST_CHECK_EQUAL(hashes.size(), 102U);
+    BOOST_CHECK(has_spend_block(hashes));
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    index.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_bulk_build, InsightIndexSetup<TestChain100Setup>)
+{
+    const CScript script_a{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const auto [hash_a, type_a] = AddressKey(script_a);
+    CKey key_b;
+    key_b.MakeNewKey(true);
+    const CScript script_b{GetScriptForDestination(PKHash(key_b.GetPubKey()))};
+    const auto [hash_b, type_b] = AddressKey(script_b);
+
+    // A block that creates and spends an output of address a, so the bulk
+    // build has to drop it from the unspent index.
+    const CMutableTransaction tx_1{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, script_a, 1 * COIN, /*submit=*/false)};
+    const CMutableTransaction tx_2{CreateValidMempoolTransaction(MakeTransactionRef(tx_1), 0, 101, coinbaseKey, script_b, COIN / 2, /*submit=*/false)};
+    const CBlock spend_block{CreateAndProcessBlock({tx_1, tx_2}, script_a)};
+
+    const auto sync{[](InsightIndex& index) {
+        BOOST_REQUIRE(index.Start());
+        constexpr int64_t timeout_ms = 10 * 1000;
+        int64_t time_start = GetTimeMillis();
+        while (!index.BlockUntilSyncedToCurrentChain()) {
+            BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+            UninterruptibleSleep(std::chrono::milliseconds{100});
+        }
+    }};
+
+    gArgs.ForceSetArg("-indexbulkheight", "1");
+    InsightIndex bulk(interfaces::MakeChain(m_node), 1 << 20, true);
+    sync(bulk);
+    gArgs.ForceSetArg("-indexbulkheight", "0");
+    InsightIndex blockwise(interfaces::MakeChain(m_node), 1 << 20, true);
+    sync(blockwise);
+
+    interfaces::BlockKey best_block;
+    BOOST_REQUIRE(bulk.ReadBestBlock(best_block));
+    BOOST_CHECK(best_block.hash == spend_block.GetHash());
+    BOOST_CHECK_EQUAL(best_block.height, 101);
+    BOOST_CHECK(!fs::exists(gArgs.GetDataDirNet() / "indexes" / "insight_bulk"));
+
+    // Both ways of building the index give the same entries.
+    for (const auto& [hash, type] : {std::make_pair(hash_a, type_a), std::make_pair(hash_b, type_b)}) {
+        std::vector<std::pair<CAddressIndexKey, CAmount>> bulk_index, blockwise_index;
+        BOOST_CHECK(bulk.ReadAddressIndex(hash, type, bulk_index));
+        BOOST_CHECK(blockwise.ReadAddressIndex(hash, type, blockwise_index));
+        BOOST_CHECK(bulk_index == blockwise_index);
+
+        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> bulk_unspent, blockwise_unspent;
+        BOOST_CHECK(bulk.ReadAddressUnspentIndex(hash, type, bulk_unspent));
+        BOOST_CHECK(blockwise.ReadAddressUnspentIndex(hash, type, blockwise_unspent));
+        BOOST_REQUIRE_EQUAL(bulk_unspent.size(), blockwise_unspent.size());
+        for (size_t i = 0; i < bulk_unspent.size(); ++i) {
+            BOOST_CHECK(bulk_unspent[i].first == blockwise_unspent[i].first);
+            BOOST_CHECK_EQUAL(EncodeHex(bulk_unspent[i].second), EncodeHex(blockwise_unspent[i].second));
+        }
+
+        CAddressBalanceValue bulk_balance, blockwise_balance;
+        BOOST_REQUIRE(bulk.ReadAddressBalance(hash, type, bulk_balance));
+        BOOST_REQUIRE(blockwise.ReadAddressBalance(hash, type, blockwise_balance));
+        BOOST_CHECK_EQUAL(EncodeHex(bulk_balance), EncodeHex(blockwise_balance));
+    }
+    // And those are the entries of the chain, not two empty indexes.
+    std::vector<std::pair<CAddressIndexKey, CAmount>> index_a;
+    BOOST_CHECK(bulk.ReadAddressIndex(hash_a, type_a, index_a));
+    BOOST_CHECK_EQUAL(index_a.size(), 3U); // coinbase, tx_1 output, tx_2 spend
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent_a;
+    BOOST_CHECK(bulk.ReadAddressUnspentIndex(hash_a, type_a, unspent_a));
+    BOOST_REQUIRE_EQUAL(unspent_a.size(), 1U);
+    BOOST_CHECK(unspent_a[0].first.txhash == spend_block.vtx[0]->GetHash());
+    CAddressBalanceValue balance_b;
+    BOOST_REQUIRE(bulk.ReadAddressBalance(hash_b, type_b, balance_b));
+    BOOST_CHECK_EQUAL(balance_b.balance, COIN / 2);
+    BOOST_CHECK_EQUAL(balance_b.txCount, 1U);
+
+    CSpentIndexValue bulk_spent, blockwise_spent;
+    BOOST_REQUIRE(bulk.ReadSpentIndex(CSpentIndexKey(tx_1.GetHash(), 0), bulk_spent));
+    BOOST_REQUIRE(blockwise.ReadSpentIndex(CSpentIndexKey(tx_1.GetHash(), 0), blockwise_spent));
+    BOOST_CHECK_EQUAL(EncodeHex(bulk_spent), EncodeHex(blockwise_spent));
+
+    gArgs.ForceSetArg("-indexbulkheight", strprintf("%d", DEFAULT_INDEX_BULK_HEIGHT));
+    bulk.Stop();
+    blockwise.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
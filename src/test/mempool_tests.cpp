@@ -2,7 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addressnotifier.h>
 #include <policy/policy.h>
+#include <script/standard.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <util/system.h>
@@ -800,4 +802,79 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolAddressSpentIndexTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    const uint256 hash_a{uint256S("aa")};
+    const uint256 hash_b{uint256S("bb")};
+    const auto p2pkh{[](const uint256& hash) { return GetScriptForDestination(PKHash{uint160{Span{hash}.first(20)}}); }};
+
+    CMutableTransaction parent;
+    parent.vin.resize(1);
+    parent.vout.resize(1);
+    parent.vout[0].scriptPubKey = p2pkh(hash_a);
+    parent.vout[0].nValue = 10 * COIN;
+
+    CMutableTransaction child;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint(parent.GetHash(), 0);
+    child.vout.resize(2);
+    child.vout[0].scriptPubKey = p2pkh(hash_a);
+    child.vout[0].nValue = 3 * COIN;
+    child.vout[1].scriptPubKey = p2pkh(hash_b);
+    child.vout[1].nValue = 7 * COIN;
+
+    CCoinsView base;
+    CCoinsViewCache view{&base};
+    AddCoins(view, CTransaction{parent}, /*nHeight=*/1);
+    g_address_notifier = std::make_unique<AddressDeltaNotifier>();
+    g_address_notifier->Watch(1, hash_b);
+    for (const auto& tx : {parent, child}) {
+        const CTxMemPoolEntry tx_entry{entry.FromTx(tx)};
+        pool.addAddressIndex(tx_entry, view);
+        pool.addSpentIndex(tx_entry, view);
+        pool.addUnchecked(tx_entry);
+    }
+
+    std::vector<std::pair<uint256, int>> addresses{{hash_a, 1}};
+    std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> deltas;
+    BOOST_CHECK(pool.getAddressIndex(addresses, deltas));
+    BOOST_CHECK_EQUAL(deltas.size(), 3U);
+    CAmount balance{0};
+    for (const auto& [key, delta] : deltas) balance += delta.amount;
+    BOOST_CHECK_EQUAL(balance, 3 * COIN);
+
+    CSpentIndexValue spent;
+    BOOST_REQUIRE(pool.getSpentIndex(CSpentIndexKey(parent.GetHash(), 0), spent));
+    BOOST_CHECK(spent.txid == child.GetHash());
+    BOOST_CHECK_EQUAL(spent.satoshis, 10 * COIN);
+
+    // Deltas of watched addresses are pushed as they are indexed.
+    std::vector<AddressDeltaEvent> events;
+    BOOST_CHECK_EQUAL(g_address_notifier->GetEvents(0, 10, events), 1U);
+    BOOST_REQUIRE_EQUAL(events.size(), 1U);
+    BOOST_CHECK(events[0].txid == child.GetHash());
+    BOOST_CHECK_EQUAL(events[0].index, 1U);
+    BOOST_CHECK_EQUAL(events[0].satoshis, 7 * COIN);
+    BOOST_CHECK_EQUAL(events[0].status, AddressDeltaEvent::MEMPOOL);
+    g_address_notifier.reset();
+
+    // Removing the child from the mempool drops its deltas and spends.
+    pool.removeRecursive(CTransaction{child}, REMOVAL_REASON_DUMMY);
+    addresses.emplace_back(hash_b, 1);
+    deltas.clear();
+    BOOST_CHECK(pool.getAddressIndex(addresses, deltas));
+    BOOST_REQUIRE_EQUAL(deltas.size(), 1U);
+    BOOST_CHECK(deltas[0].first.txhash == parent.GetHash());
+    BOOST_CHECK(!pool.getSpentIndex(CSpentIndexKey(parent.GetHash(), 0), spent));
+
+    pool.removeRecursive(CTransaction{parent}, REMOVAL_REASON_DUMMY);
+    deltas.clear();
+    BOOST_CHECK(pool.getAddressIndex(addresses, deltas));
+    BOOST_CHECK(deltas.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,14 +2,19 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <chain.h>
 #include <chainparams.h>
+#include <crypto/yespower.h>
 #include <pow.h>
+#include <streams.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+
 BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
 
 /* Test calculation of next difficulty target with no constraints applying */
@@ -252,6 +257,100 @@ void sanity_check_chainparams(const ArgsManager& args, std::string chainName)
     }
 }
 
+/* SugarShield */
+BOOST_AUTO_TEST_CASE(difficulty_window)
+{
+    const auto chainParams = CreateChainParams(*m_node.args, CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    const arith_uint256 pow_limit{UintToArith256(params.powLimit)};
+    const auto make_chain = [&](std::vector<CBlockIndex>& blocks, CBlockIndex* parent) {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            CBlockIndex* prev = i ? &blocks[i - 1] : parent;
+            blocks[i].pprev = prev;
+            blocks[i].nHeight = prev ? prev->nHeight + 1 : 0;
+            blocks[i].nTime = prev ? prev->nTime + InsecureRandRange(2 * params.nPowTargetSpacing) : 1269211443;
+            blocks[i].nBits = arith_uint256{pow_limit >> InsecureRandRange(20)}.GetCompact();
+        }
+    };
+    std::vector<CBlockIndex> chain(3 * params.nPowAveragingWindow);
+    make_chain(chain, nullptr);
+    std::vector<CBlockIndex> fork(params.nPowAveragingWindow / 2);
+    make_chain(fork, &chain[2 * params.nPowAveragingWindow]);
+
+    // Extending the chain one block at a time, including the short chain near genesis
+    DifficultyWindow window;
+    for (const CBlockIndex& block : chain) {
+        BOOST_CHECK_EQUAL(window.GetNextWorkRequired(&block, params), GetNextWorkRequired(&block, nullptr, params));
+    }
+    // Asking again for the same block
+    BOOST_CHECK_EQUAL(window.GetNextWorkRequired(&chain.back(), params), GetNextWorkRequired(&chain.back(), nullptr, params));
+    // Reorg to a fork, then back to the main chain, then to an ancestor
+    for (const CBlockIndex& block : fork) {
+        BOOST_CHECK_EQUAL(window.GetNextWorkRequired(&block, params), GetNextWorkRequired(&block, nullptr, params));
+    }
+    for (const CBlockIndex* block : {&chain.back(), &chain[params.nPowAveragingWindow], &chain[10]}) {
+        BOOST_CHECK_EQUAL(window.GetNextWorkRequired(block, params), GetNextWorkRequired(block, nullptr, params));
+    }
+    window.Clear();
+    BOOST_CHECK_EQUAL(window.GetNextWorkRequired(&fork.back(), params), GetNextWorkRequired(&fork.back(), nullptr, params));
+}
+
+/* YespowerSugar */
+BOOST_AUTO_TEST_CASE(pow_hash_cache)
+{
+    const auto chainParams = CreateChainParams(*m_node.args, CBaseChainParams::MAIN);
+    const CBlockHeader genesis{chainParams->GenesisBlock().GetBlockHeader()};
+    const uint256 block_hash{genesis.GetHash()};
+    const uint256 pow_hash{genesis.GetPoWHash()};
+    BOOST_CHECK(!genesis.GetCachedPoWHash(block_hash));
+
+    // Concurrent first calls all see the same value, and exactly one is published.
+    std::vector<std::thread> threads;
+    std::vector<uint256> results(4);
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i] { results[i] = genesis.GetPoWHash_cached(); });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const uint256& result : results) BOOST_CHECK_EQUAL(result, pow_hash);
+    BOOST_CHECK(genesis.GetCachedPoWHash(block_hash) == pow_hash);
+    BOOST_CHECK(!genesis.GetCachedPoWHash(uint256::ONE));
+
+    // Copies carry the cache along; once filled it is never overwritten.
+    CBlockHeader copy{genesis};
+    BOOST_CHECK(copy.GetCachedPoWHash(block_hash) == pow_hash);
+    copy.SetPoWHashCache(block_hash, uint256::ONE);
+    BOOST_CHECK(copy.GetCachedPoWHash(block_hash) == pow_hash);
+    copy = CBlockHeader{};
+    BOOST_CHECK(!copy.GetCachedPoWHash(block_hash));
+    copy.SetPoWHashCache(block_hash, pow_hash);
+    BOOST_CHECK(copy.GetCachedPoWHash(block_hash) == pow_hash);
+}
+
+BOOST_AUTO_TEST_CASE(pow_hash_serialization)
+{
+    // GetPoWHash() serializes the header by hand; it must hash the same bytes as the stream serialization.
+    static const yespower_params_t params = {
+        .version = YESPOWER_1_0,
+        .N = 2048,
+        .r = 32,
+        .pers = (const uint8_t*)"Satoshi Nakamoto 31/Oct/2008 Proof-of-work is essentially one-CPU-one-vote",
+        .perslen = 74,
+    };
+    CBlockHeader header;
+    header.nVersion = -0x12345678;
+    header.hashPrevBlock = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = InsecureRand32();
+    header.nBits = InsecureRand32();
+    header.nNonce = InsecureRand32();
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << header;
+    BOOST_CHECK_EQUAL(ss.size(), 80U);
+    uint256 expected;
+    BOOST_CHECK_EQUAL(YespowerTLS(UCharCast(ss.data()), ss.size(), &params, (yespower_binary_t*)&expected), 0);
+    BOOST_CHECK_EQUAL(header.GetPoWHash(), expected);
+}
+
 BOOST_AUTO_TEST_CASE(ChainParams_MAIN_sanity)
 {
     sanity_check_chainparams(*m_node.args, CBaseChainParams::MAIN);
@@ -0,0 +1,162 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memusage.h>
+#include <slabhashmap.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+BOOST_FIXTURE_TEST_SUITE(slabhashmap_tests, BasicTestingSetup)
+
+namespace {
+/** Maps keys to few distinct hashes, so that probe sequences get long and
+ *  erasing has to shift slots around. */
+struct CollidingHasher {
+    size_t operator()(uint32_t key) const { return (key % 37) * size_t{0x9e3779b97f4a7c15ULL}; }
+};
+
+using TestMap = SlabHashMap<uint32_t, std::string, CollidingHasher>;
+
+void CheckEqual(const TestMap& map, const std::unordered_map<uint32_t, std::string>& expected)
+{
+    BOOST_CHECK_EQUAL(map.size(), expected.size());
+    BOOST_CHECK_EQUAL(map.empty(), expected.empty());
+    size_t count{0};
+    for (const auto& [key, value] : map) {
+        const auto it{expected.find(key)};
+        BOOST_REQUIRE(it != expected.end());
+        BOOST_CHECK_EQUAL(value, it->second);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, expected.size());
+    for (const auto& [key, value] : expected) {
+        const auto it{map.find(key)};
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, value);
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(random_operations)
+{
+    TestMap map;
+    std::unordered_map<uint32_t, std::string> expected;
+    // Entries must not move, whatever happens to the others.
+    std::map<uint32_t, const std::string*> addresses;
+
+    for (int i = 0; i < 20000; ++i) {
+        const uint32_t key = InsecureRandRange(2000);
+        switch (InsecureRandRange(4)) {
+        case 0:
+        case 1: {
+            const std::string value{std::to_string(InsecureRand32())};
+            const auto [it, inserted]{map.emplace(key, value)};
+            BOOST_CHECK_EQUAL(inserted, expected.emplace(key, value).second);
+            if (inserted) addresses[key] = &it->second;
+            BOOST_CHECK_EQUAL(addresses[key], &it->second);
+            break;
+        }
+        case 2: {
+            auto it{map.find(key)};
+            BOOST_CHECK_EQUAL(it == map.end(), expected.erase(key) == 0);
+            if (it != map.end()) {
+                map.erase(it);
+                addresses.erase(key);
+            }
+            break;
+        }
+        case 3:
+            map[key] += "x";
+            expected[key] += "x";
+            if (!addresses.count(key)) addresses[key] = &map.find(key)->second;
+            break;
+        }
+        if (i % 1000 == 0) CheckEqual(map, expected);
+    }
+    CheckEqual(map, expected);
+    for (const auto& [key, address] : addresses) {
+        BOOST_CHECK_EQUAL(&map.find(key)->second, address);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(erase_while_iterating)
+{
+    TestMap map;
+    std::unordered_map<uint32_t, std::string> expected;
+    for (uint32_t key = 0; key < 1000; ++key) {
+        map.emplace(key, std::to_string(key));
+        expected.emplace(key, std::to_string(key));
+    }
+
+    // Erase every other entry in iteration order, as CCoinsViewCache::Sync does.
+    bool erase{false};
+    size_t visited{0};
+    for (auto it = map.begin(); it != map.end();) {
+        ++visited;
+        if ((erase = !erase)) {
+            expected.erase(it->first);
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    BOOST_CHECK_EQUAL(visited, 1000U);
+    CheckEqual(map, expected);
+
+    // Erase all of them, as CCoinsViewCache::Flush does.
+    for (auto it = map.begin(); it != map.end(); it = map.erase(it)) {}
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+    BOOST_CHECK(map.find(1) == map.end());
+
+    // The storage is reused.
+    const size_t slabs{map.slab_count()};
+    for (uint32_t key = 0; key < 1000; ++key) {
+        map.emplace(key, std::to_string(key));
+    }
+    BOOST_CHECK_EQUAL(map.slab_count(), slabs);
+    BOOST_CHECK_EQUAL(map.size(), 1000U);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    TestMap map;
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), 0U);
+
+    map.emplace(1, "");
+    BOOST_CHECK_EQUAL(map.slab_count(), 1U);
+    BOOST_CHECK_EQUAL(map.bucket_count(), 16U);
+    const size_t usage{memusage::DynamicUsage(map)};
+    BOOST_CHECK_EQUAL(usage, memusage::MallocUsage(sizeof(TestMap::Slab)) + memusage::MallocUsage(sizeof(void*)) +
+                                 memusage::MallocUsage(16 * sizeof(TestMap::Slot)));
+
+    // Up to 3/4 of the table is used before it grows.
+    for (uint32_t key = 2; key <= 12; ++key) {
+        map.emplace(key, "");
+    }
+    BOOST_CHECK_EQUAL(map.bucket_count(), 16U);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), usage);
+    map.emplace(13, "");
+    BOOST_CHECK_EQUAL(map.bucket_count(), 32U);
+
+    for (uint32_t key = 14; key <= TestMap::SLAB_ENTRIES; ++key) {
+        map.emplace(key, "");
+    }
+    BOOST_CHECK_EQUAL(map.slab_count(), 1U);
+    map.emplace(0, "");
+    BOOST_CHECK_EQUAL(map.slab_count(), 2U);
+
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK_EQUAL(map.slab_count(), 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -192,12 +192,15 @@ ChainTestingSetup::ChainTestingSetup(const std::string& chainName, const std::ve
 
     constexpr int script_check_threads = 2;
     StartScriptCheckWorkerThreads(script_check_threads);
+    constexpr int pow_check_threads = 2;
+    StartPoWCheckWorkerThreads(pow_check_threads);
 }
 
 ChainTestingSetup::~ChainTestingSetup()
 {
     if (m_node.scheduler) m_node.scheduler->stop();
     StopScriptCheckWorkerThreads();
+    StopPoWCheckWorkerThreads();
     GetMainSignals().FlushBackgroundCallbacks();
     GetMainSignals().UnregisterBackgroundSignalScheduler();
     m_node.connman.reset();
@@ -285,7 +288,7 @@ TestChain100Setup::TestChain100Setup(
         LOCK(::cs_main);
         assert(
             m_node.chainman->ActiveChain().Tip()->GetBlockHash().ToString() ==
-            "571d80a9967ae599cec0448b0b0ba1cfb606f584d8069bd7166b86854ba7a191");
+            "237bb8219d10acb3a9cda752a8070dd9cf542cba276fbc88734d1288056dad16");
     }
 }
 
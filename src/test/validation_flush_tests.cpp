@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 //
+#include <memusage.h>
 #include <sync.h>
 #include <test/util/coins.h>
 #include <test/util/random.h>
@@ -36,52 +37,34 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
         BOOST_TEST_MESSAGE("CCoinsViewCache memory usage: " << view.DynamicMemoryUsage());
     };
 
-    constexpr size_t MAX_COINS_CACHE_BYTES = 1024;
+    // Without any coins the cache map takes no memory. Its first coins take
+    // one slab and a table of 16 slots.
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), 0U);
+    const size_t map_usage{memusage::MallocUsage(sizeof(CCoinsMap::Slab)) + memusage::MallocUsage(sizeof(void*)) +
+                           memusage::MallocUsage(16 * sizeof(CCoinsMap::Slot))};
+
+    // We should be able to add COINS_UNTIL_LARGE coins to the cache before it
+    // is no longer OK.
+    constexpr int COINS_UNTIL_LARGE{3};
+    const size_t MAX_COINS_CACHE_BYTES{(map_usage + COINS_UNTIL_LARGE * COIN_SIZE) * 10 / 9 + 1};
 
     // Without any coins in the cache, we shouldn't need to flush.
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
         CoinsCacheSizeState::OK);
 
-    // If the initial memory allocations of cacheCoins don't match these common
-    // cases, we can't really continue to make assertions about memory usage.
-    // End the test early.
-    if (view.DynamicMemoryUsage() != 32 && view.DynamicMemoryUsage() != 16) {
-        // Add a bunch of coins to see that we at least flip over to CRITICAL.
-
-        for (int i{0}; i < 1000; ++i) {
-            const COutPoint res = AddTestCoin(view);
-            BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
-        }
-
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
-            CoinsCacheSizeState::CRITICAL);
-
-        BOOST_TEST_MESSAGE("Exiting cache flush tests early due to unsupported arch");
-        return;
-    }
-
-    print_view_mem_usage(view);
-    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), is_64_bit ? 32U : 16U);
-
-    // We should be able to add COINS_UNTIL_CRITICAL coins to the cache before going CRITICAL.
-    // This is contingent not only on the dynamic memory usage of the Coins
-    // that we're adding (COIN_SIZE bytes per), but also on how much memory the
-    // cacheCoins (unordered_map) preallocates.
-    constexpr int COINS_UNTIL_CRITICAL{3};
-
-    for (int i{0}; i < COINS_UNTIL_CRITICAL; ++i) {
+    for (int i{0}; i < COINS_UNTIL_LARGE; ++i) {
         const COutPoint res = AddTestCoin(view);
         print_view_mem_usage(view);
         BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
+        BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), map_usage + (i + 1) * COIN_SIZE);
         BOOST_CHECK_EQUAL(
             chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
             CoinsCacheSizeState::OK);
     }
 
     // Adding some additional coins will push us over the edge to CRITICAL.
-    for (int i{0}; i < 4; ++i) {
+    for (int i{0}; i < 20; ++i) {
         AddTestCoin(view);
         print_view_mem_usage(view);
         if (chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0) ==
@@ -96,18 +79,18 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
 
     // Passing non-zero max mempool usage should allow us more headroom.
     BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 10),
+        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 19),
         CoinsCacheSizeState::OK);
 
     for (int i{0}; i < 3; ++i) {
         AddTestCoin(view);
         print_view_mem_usage(view);
         BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 10),
+            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 19),
             CoinsCacheSizeState::OK);
     }
 
-    // Adding another coin with the additional mempool room will put us >90%
+    // Adding another coin with less additional mempool room will put us >90%
     // but not yet critical.
     AddTestCoin(view);
     print_view_mem_usage(view);
@@ -131,20 +114,20 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
             CoinsCacheSizeState::OK);
     }
 
-    // Flushing the view doesn't take us back to OK because cacheCoins has
-    // preallocated memory that doesn't get reclaimed even after flush.
-
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
         CoinsCacheSizeState::CRITICAL);
 
+    // Flushing the view releases the memory of cacheCoins, which takes us
+    // back to OK.
     view.SetBestBlock(InsecureRand256());
     BOOST_CHECK(view.Flush());
     print_view_mem_usage(view);
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), 0U);
 
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
-        CoinsCacheSizeState::CRITICAL);
+        CoinsCacheSizeState::OK);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
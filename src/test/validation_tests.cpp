@@ -121,6 +121,25 @@ BOOST_AUTO_TEST_CASE(signet_parse_tests)
     BOOST_CHECK(!CheckSignetBlockSolution(block, signet_params->GetConsensus()));
 }
 
+BOOST_AUTO_TEST_CASE(header_batch_pow_test)
+{
+    const auto params = CreateChainParams(*m_node.args, CBaseChainParams::MAIN);
+    const Consensus::Params& consensus = params->GetConsensus();
+
+    // Hashed on the worker pool started by the testing setup.
+    std::vector<CBlockHeader> headers(8, params->GenesisBlock().GetBlockHeader());
+    BOOST_CHECK(HasValidProofOfWork(headers, consensus));
+    BOOST_CHECK(HasValidProofOfWork({params->GenesisBlock().GetBlockHeader()}, consensus));
+    BOOST_CHECK(HasValidProofOfWork({}, consensus));
+
+    // A single header that does not meet its target fails the whole batch.
+    CBlockHeader bad_header{params->GenesisBlock().GetBlockHeader()};
+    bad_header.nBits = 0x1d00ffff;
+    headers[5] = bad_header;
+    BOOST_CHECK(!HasValidProofOfWork(headers, consensus));
+    BOOST_CHECK(!HasValidProofOfWork({bad_header}, consensus));
+}
+
 //! Test retrieval of valid assumeutxo values.
 BOOST_AUTO_TEST_CASE(test_assumeutxo)
 {
@@ -5,6 +5,7 @@
 
 #include <txmempool.h>
 
+#include <addressnotifier.h>
 #include <chain.h>
 #include <coins.h>
 #include <consensus/consensus.h>
@@ -502,6 +503,10 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 
     RemoveUnbroadcastTx(hash, true /* add logging because unchecked */ );
 
+    /* YespowerSugar */
+    if (!m_address_index.empty()) m_address_index.Remove(hash);
+    if (!m_spent_index.empty()) m_spent_index.Remove(it->GetTx());
+
     if (vTxHashes.size() > 1) {
         vTxHashes[it->vTxHashesIdx] = std::move(vTxHashes.back());
         vTxHashes[it->vTxHashesIdx].second->vTxHashesIdx = it->vTxHashesIdx;
@@ -525,17 +530,15 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
 {
     LOCK(cs);
     const CTransaction& tx = entry.GetTx();
-    std::vector<CMempoolAddressDeltaKey> inserted;
-
-    // ToDo: extract address hash and script type here
+    std::vector<CMempoolAddressIndex::Delta> deltas;
+    std::vector<unsigned char> hashBytes;
 
-    uint256 txhash = tx.GetHash();
+    const uint256& txhash = tx.GetHash();
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
-        const CTxIn input = tx.vin[j];
+        const CTxIn& input = tx.vin[j];
         const Coin& coin = view.AccessCoin(input.prevout);
         const CTxOut &prevout = coin.out;
 
-        std::vector<unsigned char> hashBytes;
         int scriptType = 0;
 
         if (!ExtractIndexInfo(&prevout.scriptPubKey, scriptType, hashBytes)
@@ -545,14 +548,12 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
 
         CMempoolAddressDeltaKey key(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, j, 1);
         CMempoolAddressDelta delta(count_seconds(entry.GetTime()), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-        mapAddress.insert(std::make_pair(key, delta));
-        inserted.push_back(key);
+        deltas.emplace_back(key, delta);
     }
 
     for (unsigned int k = 0; k < tx.vout.size(); k++) {
         const CTxOut &out = tx.vout[k];
 
-        std::vector<unsigned char> hashBytes;
         int scriptType = 0;
 
         if (!ExtractIndexInfo(&out.scriptPubKey, scriptType, hashBytes)
@@ -561,23 +562,27 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
         }
 
         CMempoolAddressDeltaKey key(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, k, 0);
-        mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(count_seconds(entry.GetTime()), out.nValue)));
-        inserted.push_back(key);
+        deltas.emplace_back(key, CMempoolAddressDelta(count_seconds(entry.GetTime()), out.nValue));
+    }
+
+    if (g_address_notifier && g_address_notifier->IsWatching()) {
+        std::vector<AddressDeltaEvent> events;
+        events.reserve(deltas.size());
+        for (const auto& [key, delta] : deltas) {
+            events.emplace_back(AddressDeltaEvent::MEMPOOL, key.type, key.addressBytes, txhash, key.index, key.spending, delta.amount, /*height_in=*/-1);
+        }
+        g_address_notifier->Notify(std::move(events));
     }
 
-    mapAddressInserted.insert(std::make_pair(txhash, inserted));
+    m_address_index.Add(txhash, deltas);
 }
 
 bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint256, int> > &addresses,
                                  std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results) const
 {
     LOCK(cs);
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        addressDeltaMap::const_iterator ait = mapAddress.lower_bound(CMempoolAddressDeltaKey((*it).second, (*it).first));
-        while (ait != mapAddress.end() && (*ait).first.addressBytes == (*it).first && (*ait).first.type == (*it).second) {
-            results.push_back(*ait);
-            ait++;
-        }
+    for (const auto& [hash, type] : addresses) {
+        m_address_index.Get(hash, type, results);
     }
     return true;
 }
@@ -585,16 +590,7 @@ bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint256, int> > &addresse
 bool CTxMemPool::removeAddressIndex(const uint256 txhash)
 {
     LOCK(cs);
-    addressDeltaMapInserted::iterator it = mapAddressInserted.find(txhash);
-
-    if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
-        }
-        mapAddressInserted.erase(it);
-    }
-
+    m_address_index.Remove(txhash);
     return true;
 }
 
@@ -603,15 +599,14 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
     LOCK(cs);
 
     const CTransaction& tx = entry.GetTx();
-    std::vector<CSpentIndexKey> inserted;
+    std::vector<unsigned char> hashBytes;
 
-    uint256 txhash = tx.GetHash();
+    const uint256& txhash = tx.GetHash();
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
-        const CTxIn input = tx.vin[j];
+        const CTxIn& input = tx.vin[j];
         const Coin& coin = view.AccessCoin(input.prevout);
         const CTxOut &prevout = coin.out;
 
-        std::vector<unsigned char> hashBytes;
         int scriptType = 0;
 
         if (!ExtractIndexInfo(&prevout.scriptPubKey, scriptType, hashBytes)
@@ -622,38 +617,20 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
         CSpentIndexKey key = CSpentIndexKey(input.prevout.hash, input.prevout.n);
         CSpentIndexValue value = CSpentIndexValue(txhash, j, -1, prevout.nValue, scriptType, uint256(hashBytes.data(), hashBytes.size()));
 
-        mapSpent.insert(std::make_pair(key, value));
-        inserted.push_back(key);
-
+        m_spent_index.Add(key, value);
     }
-
-    mapSpentInserted.insert(make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const
 {
     LOCK(cs);
-    mapSpentIndex::const_iterator it = mapSpent.find(key);
-    if (it != mapSpent.end()) {
-        value = it->second;
-        return true;
-    }
-    return false;
+    return m_spent_index.Get(key, value);
 }
 
-bool CTxMemPool::removeSpentIndex(const uint256 txhash)
+bool CTxMemPool::removeSpentIndex(const CTransaction& tx)
 {
     LOCK(cs);
-    mapSpentIndexInserted::iterator it = mapSpentInserted.find(txhash);
-
-    if (it != mapSpentInserted.end()) {
-        std::vector<CSpentIndexKey> keys = (*it).second;
-        for (std::vector<CSpentIndexKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapSpent.erase(*mit);
-        }
-        mapSpentInserted.erase(it);
-    }
-
+    m_spent_index.Remove(tx);
     return true;
 }
 
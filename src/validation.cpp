@@ -1974,10 +1974,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     */
     bool fEnforceBIP30 = true;
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
-
     // undo transactions in reverse order
     for (int i = block.vtx.size() - 1; i >= 0; i--) {
         const CTransaction &tx = *(block.vtx[i]);
@@ -1985,28 +1981,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
         bool is_coinbase = tx.IsCoinBase();
         bool is_bip30_exception = (is_coinbase && !fEnforceBIP30);
 
-        if (fAddressIndex) {
-
-            for (unsigned int k = tx.vout.size(); k-- > 0;) {
-                const CTxOut &out = tx.vout[k];
-
-                std::vector<unsigned char> hashBytes;
-                int scriptType = 0;
-
-                if (!ExtractIndexInfo(&out.scriptPubKey, scriptType, hashBytes)
-                    || scriptType == 0) {
-                    continue;
-                }
-
-                // undo receiving activity
-                addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, hash, k, false), out.nValue));
-
-                // undo unspent index
-                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), hash, k), CAddressUnspentValue()));
-            }
-
-        }
-
         // Check that all outputs are available and match the outputs in the block itself
         // exactly.
         for (size_t o = 0; o < tx.vout.size(); o++) {
@@ -2032,52 +2006,14 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
             for (unsigned int j = tx.vin.size(); j > 0;) {
                 --j;
                 const COutPoint& out = tx.vin[j].prevout;
-                int undoHeight = txundo.vprevout[j].nHeight;
                 int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
                 if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
                 fClean = fClean && res != DISCONNECT_UNCLEAN;
-
-                const CTxIn input = tx.vin[j];
-
-                if (fSpentIndex) {
-                    // undo and delete the spent index
-                    spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
-                }
-
-                if (fAddressIndex) {
-                    const Coin &coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-
-                    std::vector<unsigned char> hashBytes;
-                    int scriptType = 0;
-
-                    if (!ExtractIndexInfo(&prevout.scriptPubKey, scriptType, hashBytes)
-                        || scriptType == 0) {
-                        continue;
-                    }
-
-                    // undo spending activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
-
-                    // restore unspent index
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undoHeight)));
-                }
             }
             // At this point, all of txundo.vprevout should have been moved out.
         }
     }
 
-    if (fAddressIndex) {
-        if (!m_blockman.m_block_tree_db->EraseAddressIndex(addressIndex)) {
-            AbortNode("Failed to delete address index");
-            return DISCONNECT_FAILED;
-        }
-        if (!m_blockman.m_block_tree_db->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            AbortNode("Failed to write address unspent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
 
@@ -2390,14 +2326,10 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     int nInputs = 0;
     int64_t nSigOpsCost = 0;
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
 
     for (unsigned int i = 0; i < block.vtx.size(); i++)
     {
         const CTransaction &tx = *(block.vtx[i]);
-        const uint256 txhash = tx.GetHash();
 
         nInputs += tx.vin.size();
 
@@ -2429,38 +2361,6 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n", __func__);
                 return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-txns-nonfinal");
             }
-
-            if (fAddressIndex || fSpentIndex)
-            {
-                for (size_t j = 0; j < tx.vin.size(); j++) {
-                    const CTxIn input = tx.vin[j];
-                    const Coin& coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-
-                    std::vector<unsigned char> hashBytes;
-                    int scriptType = 0;
-
-                    if (!ExtractIndexInfo(&prevout.scriptPubKey, scriptType, hashBytes)
-                        || scriptType == 0) {
-                        continue;
-                    }
-
-                    if (fAddressIndex) {
-                        // record spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, txhash, j, true), prevout.nValue * -1));
-
-                        // remove address from unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                    }
-
-                    if (fSpentIndex) {
-                        // add the spent index to determine the txid and input that spent an output
-                        // and to find the amount and address from an input
-                        spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, prevout.nValue, scriptType, uint256(hashBytes.data(), hashBytes.size()))));
-                    }
-                }
-
-            }
         }
 
         // GetTransactionSigOpCost counts 3 types of sigops:
@@ -2488,26 +2388,6 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             control.Add(std::move(vChecks));
         }
 
-        if (fAddressIndex) {
-            for (unsigned int k = 0; k < tx.vout.size(); k++) {
-                const CTxOut &out = tx.vout[k];
-
-                std::vector<unsigned char> hashBytes;
-                int scriptType = 0;
-
-                if (!ExtractIndexInfo(&out.scriptPubKey, scriptType, hashBytes)
-                    || scriptType == 0) {
-                    continue;
-                }
-
-                // record receiving activity
-                addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, txhash, k, false), out.nValue));
-
-                // record unspent output
-                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-            }
-        }
-
         CTxUndo undoDummy;
         if (i > 0) {
             blockundo.vtxundo.push_back(CTxUndo());
@@ -2560,24 +2440,6 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         m_blockman.m_dirty_blockindex.insert(pindex);
     }
 
-    if (fAddressIndex) {
-        if (!m_blockman.m_block_tree_db->WriteAddressIndex(addressIndex)) {
-            return AbortNode(state, "Failed to write address index");
-        }
-
-        if (!m_blockman.m_block_tree_db->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            return AbortNode(state, "Failed to write address unspent index");
-        }
-    }
-
-    if (fSpentIndex)
-        if (!m_blockman.m_block_tree_db->UpdateSpentIndex(spentIndex))
-            return AbortNode(state, "Failed to write transaction index");
-
-    if (fTimestampIndex)
-        if (!m_blockman.m_block_tree_db->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
-            return AbortNode(state, "Failed to write timestamp index");
-
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
 
@@ -3013,11 +2875,15 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const auto time_1{SteadyClock::now()};
     std::shared_ptr<const CBlock> pthisBlock;
     if (!pblock) {
-        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
-        if (!ReadBlockFromDisk(*pblockNew, pindexNew, m_chainman.GetConsensus())) {
-            return AbortNode(state, "Failed to read block");
+        /* YespowerSugar */
+        if (m_block_prefetcher) pthisBlock = m_block_prefetcher->Take(pindexNew->GetBlockHash());
+        if (!pthisBlock) {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockNew, pindexNew, m_chainman.GetConsensus())) {
+                return AbortNode(state, "Failed to read block");
+            }
+            pthisBlock = pblockNew;
         }
-        pthisBlock = pblockNew;
     } else {
         LogPrint(BCLog::BENCH, "  - Using cached block\n");
         pthisBlock = pblock;
@@ -3222,6 +3088,8 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
         }
         nHeight = nTargetHeight;
 
+        PrefetchBlocks(vpindexToConnect, pblock ? pindexMostWork : nullptr); /* YespowerSugar */
+
         // Connect new blocks.
         for (CBlockIndex* pindexConnect : reverse_iterate(vpindexToConnect)) {
             if (!ConnectTip(state, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
@@ -3264,6 +3132,30 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
     return true;
 }
 
+/* YespowerSugar */
+void Chainstate::PrefetchBlocks(const std::vector<CBlockIndex*>& vpindexToConnect, const CBlockIndex* pindex_cached)
+{
+    AssertLockHeld(cs_main);
+    const int depth{m_chainman.m_options.block_prefetch};
+    if (depth <= 0) return;
+
+    for (const CBlockIndex* pindex : reverse_iterate(vpindexToConnect)) {
+        if (pindex == pindex_cached) continue;
+        if (!(pindex->nStatus & BLOCK_HAVE_DATA)) break;
+        if (!m_block_prefetcher) {
+            // The context-free checks are cached in the block, so ConnectBlock
+            // skips them, including its yespower hash.
+            m_block_prefetcher = std::make_unique<node::BlockPrefetcher>(
+                m_chainman.GetConsensus(), depth, GetNumCores() - 1,
+                [&consensus = m_chainman.GetConsensus()](const CBlock& block) {
+                    BlockValidationState state;
+                    CheckBlock(block, state, consensus);
+                });
+        }
+        if (!m_block_prefetcher->Prefetch(pindex->GetBlockHash(), pindex->GetBlockPos())) break;
+    }
+}
+
 static SynchronizationState GetSynchronizationState(bool init)
 {
     if (!init) return SynchronizationState::POST_INIT;
@@ -3798,10 +3690,60 @@ std::vector<unsigned char> ChainstateManager::GenerateCoinbaseCommitment(CBlock&
     return commitment;
 }
 
+/* YespowerSugar */
+/** Closure representing one header's proof-of-work check. The yespower
+ *  scratch memory comes from the shared context pool, so workers may wait on
+ *  each other when -maxpowmem is smaller than what all threads need. */
+class CPoWCheck
+{
+private:
+    const CBlockHeader* m_header;
+    const Consensus::Params* m_params;
+
+public:
+    CPoWCheck(const CBlockHeader& header, const Consensus::Params& params) : m_header(&header), m_params(&params) {}
+
+    bool operator()() const
+    {
+        return CheckProofOfWork(m_header->GetPoWHash_cached(), m_header->nBits, *m_params);
+    }
+};
+
+static CCheckQueue<CPoWCheck> powcheckqueue(4);
+
+void StartPoWCheckWorkerThreads(int threads_num)
+{
+    powcheckqueue.StartWorkerThreads(threads_num, "powch");
+}
+
+void StopPoWCheckWorkerThreads()
+{
+    powcheckqueue.StopWorkerThreads();
+}
+
 bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams)
 {
-    return std::all_of(headers.cbegin(), headers.cend(),
-            [&](const auto& header) { return CheckProofOfWork(header.GetPoWHash_cached(), header.nBits, consensusParams);});
+    const auto time_start{SteadyClock::now()};
+    bool valid;
+    if (headers.size() > 1 && powcheckqueue.HasThreads()) {
+        std::vector<CPoWCheck> checks;
+        checks.reserve(headers.size());
+        for (const CBlockHeader& header : headers) {
+            checks.emplace_back(header, consensusParams);
+        }
+        // Workers stop picking up new checks once any of them fails.
+        CCheckQueueControl<CPoWCheck> control(&powcheckqueue);
+        control.Add(std::move(checks));
+        valid = control.Wait();
+    } else {
+        valid = std::all_of(headers.cbegin(), headers.cend(),
+                [&](const auto& header) { return CheckProofOfWork(header.GetPoWHash_cached(), header.nBits, consensusParams);});
+    }
+    const auto time_elapsed{SteadyClock::now() - time_start};
+    LogPrint(BCLog::BENCH, "- Check PoW of %u headers: %.2fms (%.1f headers/s)\n", headers.size(),
+             Ticks<MillisecondsDouble>(time_elapsed),
+             headers.size() / std::max(Ticks<SecondsDouble>(time_elapsed), 1e-9));
+    return valid;
 }
 
 arith_uint256 CalculateHeadersWork(const std::vector<CBlockHeader>& headers)
@@ -3831,7 +3773,7 @@ static bool ContextualCheckBlockHeader(const CBlockHeader& block, BlockValidatio
 
     // Check proof of work
     const Consensus::Params& consensusParams = chainman.GetConsensus();
-    if (block.nBits != GetNextWorkRequired(pindexPrev, &block, consensusParams))
+    if (block.nBits != blockman.m_difficulty_window.GetNextWorkRequired(pindexPrev, consensusParams))
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "bad-diffbits", "incorrect proof of work");
 
     // Check against checkpoints
@@ -3971,6 +3913,9 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
                 LogPrint(BCLog::VALIDATION, "%s: block %s is marked invalid\n", __func__, hash.ToString());
                 return state.Invalid(BlockValidationResult::BLOCK_CACHED_INVALID, "duplicate");
             }
+            /* YespowerSugar */
+            // Let AcceptBlock()'s CheckBlock() reuse the PoW hash if we still have it
+            m_blockman.SeedPoWHash(block);
             return true;
         }
 
@@ -4074,24 +4019,12 @@ bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>&
     AssertLockNotHeld(cs_main);
 
     /* YespowerSugar */
-    // Look for this block's header in the index like AcceptBlock() will
+    // Reuse PoW hashes of headers we have seen recently
     {
         LOCK(cs_main);
 
         for (const CBlockHeader& header : headers) {
-            uint256 hash = header.GetHash();
-            // BlockMap::iterator miSelf = m_blockman.m_block_index.find(hash); // Use "m_blockman.m_block_index" rather than "mapBlockIndex"
-            BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
-            if (miSelf != m_blockman.m_block_index.end()) {
-                // Block header is already known
-                CBlockIndex* pindex = &(miSelf->second);
-                if (!header.cache_init && pindex->cache_init) {
-                    LOCK(header.cache_lock); // Probably unnecessary since no concurrent access to pblock is expected
-                    header.cache_init = true;
-                    header.cache_block_hash = pindex->cache_block_hash;
-                    header.cache_PoW_hash = pindex->cache_PoW_hash;
-                }
-            }
+            m_blockman.SeedPoWHash(header);
         }
     }
 
@@ -4207,6 +4140,11 @@ bool Chainstate::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockV
         return error("%s: %s", __func__, state.ToString());
     }
 
+    /* YespowerSugar */
+    // Headers accepted during IBD skip CheckBlockHeader(), so CheckBlock() may
+    // be the first to compute this block's PoW hash
+    m_blockman.RememberPoWHash(block);
+
     // Header is valid/has work, merkle tree and segwit merkle tree are good...RELAY NOW
     // (but if it does not build on our best tip, let the SendMessages loop relay it)
     if (!IsInitialBlockDownload() && m_chain.Tip() == pindex->pprev)
@@ -4245,6 +4183,10 @@ bool ChainstateManager::ProcessNewBlock(const std::shared_ptr<const CBlock>& blo
         // Therefore, the following critical section must include the CheckBlock() call as well.
         LOCK(cs_main);
 
+        /* YespowerSugar */
+        // The header usually arrived before the block, don't hash it again
+        m_blockman.SeedPoWHash(*block);
+
         // Skipping AcceptBlock() for CheckBlock() failures means that we will never mark a block as invalid if
         // CheckBlock() fails.  This is protective against consensus failure if there are any unknown forms of block
         // malleability that cause CheckBlock() to fail; see e.g. CVE-2012-2459 and
@@ -4718,18 +4660,6 @@ bool ChainstateManager::LoadBlockIndex()
         // needs_init.
 
         LogPrintf("Initializing databases...\n");
-
-        // Use the provided setting for -addressindex in the new database
-        fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-        m_blockman.m_block_tree_db->WriteFlag("addressindex", fAddressIndex);
-
-        // Use the provided setting for -timestampindex in the new database
-        fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-        m_blockman.m_block_tree_db->WriteFlag("timestampindex", fTimestampIndex);
-
-        // Use the provided setting for -spentindex in the new database
-        fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-        m_blockman.m_block_tree_db->WriteFlag("spentindex", fSpentIndex);
     }
     return true;
 }
@@ -4762,6 +4692,34 @@ bool Chainstate::LoadGenesisBlock()
     return true;
 }
 
+/* YespowerSugar */
+/** Most blocks, and most bytes of them, LoadExternalBlockFile() decodes
+ *  before accepting them. */
+static constexpr size_t MAX_EXTERNAL_BLOCK_BATCH{256};
+static constexpr size_t MAX_EXTERNAL_BLOCK_BATCH_BYTES{32 << 20};
+
+/* YespowerSugar */
+/** Compute the PoW hashes of headers on the PoW worker pool, so that their
+ *  validation finds them cached. Headers whose hash was not computed, e.g.
+ *  because the workers stopped at one with invalid PoW, are hashed by the
+ *  validation as usual. */
+static void PrecomputePoWHashes(const std::vector<const CBlockHeader*>& headers, const Consensus::Params& consensusParams)
+{
+    if (headers.size() <= 1 || !powcheckqueue.HasThreads()) return;
+
+    const auto time_start{SteadyClock::now()};
+    std::vector<CPoWCheck> checks;
+    checks.reserve(headers.size());
+    for (const CBlockHeader* header : headers) {
+        checks.emplace_back(*header, consensusParams);
+    }
+    CCheckQueueControl<CPoWCheck> control(&powcheckqueue);
+    control.Add(std::move(checks));
+    control.Wait();
+    LogPrint(BCLog::BENCH, "- Precompute PoW of %u blocks: %.2fms\n", headers.size(),
+             Ticks<MillisecondsDouble>(SteadyClock::now() - time_start));
+}
+
 void Chainstate::LoadExternalBlockFile(
     FILE* fileIn,
     FlatFilePos* dbp,
@@ -4775,59 +4733,52 @@ void Chainstate::LoadExternalBlockFile(
     const auto start{SteadyClock::now()};
     const CChainParams& params{m_chainman.GetParams()};
 
-    int nLoaded = 0;
-    try {
-        // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
-        CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
-        // nRewind indicates where to resume scanning in case something goes wrong,
-        // such as a block fails to deserialize.
-        uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
-            if (ShutdownRequested()) return;
+    /* YespowerSugar */
+    // Blocks are located in the file and, if they look like they will be
+    // accepted, decoded into a batch. The PoW hashes of a batch are computed
+    // in parallel before its blocks are accepted in file order, which is
+    // where loading used to spend nearly all of its time.
+    struct ExternalBlock {
+        uint256 hash;
+        uint256 prev_hash;
+        FlatFilePos pos;
+        //! Null if the block was not expected to be accepted
+        std::shared_ptr<CBlock> block;
+    };
+    std::vector<ExternalBlock> batch;
+    std::unordered_set<uint256, BlockHasher> batch_hashes;
+    size_t batch_bytes{0};
 
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
-                blkdat.FindByte(params.MessageStart()[0]);
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> buf;
-                if (memcmp(buf, params.MessageStart(), CMessageHeader::MESSAGE_START_SIZE)) {
-                    continue;
-                }
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                // (this happens at the end of every blk.dat file)
-                break;
+    int nLoaded = 0;
+    // Accept the blocks of the batch. Returns false if loading must stop.
+    const auto process_batch{[&]() {
+        std::vector<ExternalBlock> entries;
+        entries.swap(batch);
+        batch_hashes.clear();
+        batch_bytes = 0;
+
+        std::vector<const CBlockHeader*> headers;
+        {
+            LOCK(cs_main);
+            for (const ExternalBlock& entry : entries) {
+                if (entry.block && !m_blockman.SeedPoWHash(*entry.block)) headers.push_back(entry.block.get());
             }
+        }
+        PrecomputePoWHashes(headers, params.GetConsensus());
+
+        for (ExternalBlock& entry : entries) {
+            if (ShutdownRequested()) return false;
+
+            const uint256& hash{entry.hash};
             try {
-                // read block header
-                const uint64_t nBlockPos{blkdat.GetPos()};
-                if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                CBlockHeader header;
-                blkdat >> header;
-                const uint256 hash{header.GetHash()};
-                // Skip the rest of this block (this may read from disk into memory); position to the marker before the
-                // next block, but it's still possible to rewind to the start of the current block (without a disk read).
-                nRewind = nBlockPos + nSize;
-                blkdat.SkipTo(nRewind);
                 {
                     LOCK(cs_main);
                     // detect out of order blocks, and store them for later
-                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
+                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(entry.prev_hash)) {
                         LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                 header.hashPrevBlock.ToString());
+                                 entry.prev_hash.ToString());
                         if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
+                            blocks_with_unknown_parent->emplace(entry.prev_hash, entry.pos);
                         }
                         continue;
                     }
@@ -4835,29 +4786,33 @@ void Chainstate::LoadExternalBlockFile(
                     // process in case the block isn't known yet
                     const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
                     if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                        // This block can be processed immediately; rewind to its start, read and deserialize it.
-                        blkdat.SetPos(nBlockPos);
-                        std::shared_ptr<CBlock> pblock{std::make_shared<CBlock>()};
-                        blkdat >> *pblock;
-                        nRewind = blkdat.GetPos();
-
-                        BlockValidationState state;
-                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
-                            nLoaded++;
+                        // The parent of a block that was not decoded may have
+                        // become known since, as the out of order child of an
+                        // earlier block of the batch.
+                        if (!entry.block && dbp) {
+                            entry.block = std::make_shared<CBlock>();
+                            if (!ReadBlockFromDisk(*entry.block, entry.pos, params.GetConsensus())) continue;
                         }
-                        if (state.IsError()) {
-                            break;
+                        if (entry.block) {
+                            BlockValidationState state;
+                            if (AcceptBlock(entry.block, state, nullptr, true, dbp ? &entry.pos : nullptr, nullptr, true)) {
+                                nLoaded++;
+                            }
+                            if (state.IsError()) {
+                                return false;
+                            }
                         }
                     } else if (hash != params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
                         LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
                     }
                 }
+                entry.block.reset();
 
                 // Activate the genesis block so normal node progress can continue
                 if (hash == params.GetConsensus().hashGenesisBlock) {
                     BlockValidationState state;
                     if (!ActivateBestChain(state, nullptr)) {
-                        break;
+                        return false;
                     }
                 }
 
@@ -4890,6 +4845,92 @@ void Chainstate::LoadExternalBlockFile(
                         NotifyHeaderTip(*this);
                     }
                 }
+            } catch (const std::exception& e) {
+                // As when it is located in the file, a block that cannot be
+                // processed is skipped.
+                LogPrint(BCLog::REINDEX, "%s: error processing block %s - %s. continuing\n", __func__, hash.ToString(), e.what());
+            }
+        }
+        return true;
+    }};
+
+    try {
+        // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
+        CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
+        // nRewind indicates where to resume scanning in case something goes wrong,
+        // such as a block fails to deserialize.
+        uint64_t nRewind = blkdat.GetPos();
+        while (!blkdat.eof()) {
+            if (ShutdownRequested()) return;
+
+            /* YespowerSugar */
+            if (batch.size() >= MAX_EXTERNAL_BLOCK_BATCH || batch_bytes >= MAX_EXTERNAL_BLOCK_BATCH_BYTES) {
+                if (!process_batch()) break;
+            }
+
+            blkdat.SetPos(nRewind);
+            nRewind++; // start one byte further next time, in case of failure
+            blkdat.SetLimit(); // remove former limit
+            unsigned int nSize = 0;
+            try {
+                // locate a header
+                unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
+                blkdat.FindByte(params.MessageStart()[0]);
+                nRewind = blkdat.GetPos() + 1;
+                blkdat >> buf;
+                if (memcmp(buf, params.MessageStart(), CMessageHeader::MESSAGE_START_SIZE)) {
+                    continue;
+                }
+                // read size
+                blkdat >> nSize;
+                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
+                    continue;
+            } catch (const std::exception&) {
+                // no valid block header found; don't complain
+                // (this happens at the end of every blk.dat file)
+                break;
+            }
+            try {
+                // read block header
+                const uint64_t nBlockPos{blkdat.GetPos()};
+                if (dbp)
+                    dbp->nPos = nBlockPos;
+                blkdat.SetLimit(nBlockPos + nSize);
+                CBlockHeader header;
+                blkdat >> header;
+                ExternalBlock entry{header.GetHash(), header.hashPrevBlock, dbp ? *dbp : FlatFilePos{}, nullptr};
+                // Skip the rest of this block (this may read from disk into memory); position to the marker before the
+                // next block, but it's still possible to rewind to the start of the current block (without a disk read).
+                nRewind = nBlockPos + nSize;
+                blkdat.SkipTo(nRewind);
+
+                /* YespowerSugar */
+                // A copy of a block the batch already holds would be accepted
+                // and counted twice.
+                if (batch_hashes.count(entry.hash)) {
+                    LogPrint(BCLog::REINDEX, "%s: Duplicate block %s in the file\n", __func__, entry.hash.ToString());
+                    continue;
+                }
+                // Only decode the blocks that will be accepted, judging by
+                // the block index and the blocks ahead of them in the batch
+                bool decode;
+                {
+                    LOCK(cs_main);
+                    const CBlockIndex* pindex{m_blockman.LookupBlockIndex(entry.hash)};
+                    decode = (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) &&
+                             (entry.hash == params.GetConsensus().hashGenesisBlock ||
+                              batch_hashes.count(entry.prev_hash) || m_blockman.LookupBlockIndex(entry.prev_hash));
+                }
+                if (decode) {
+                    // This block can be processed; rewind to its start, read and deserialize it.
+                    blkdat.SetPos(nBlockPos);
+                    entry.block = std::make_shared<CBlock>();
+                    blkdat >> *entry.block;
+                    nRewind = blkdat.GetPos();
+                    batch_hashes.insert(entry.hash);
+                    batch_bytes += nSize;
+                }
+                batch.push_back(std::move(entry));
             } catch (const std::exception& e) {
                 // historical bugs added extra data to the block files that does not deserialize cleanly.
                 // commonly this data is between readable blocks, but it does not really matter. such data is not fatal to the import process.
@@ -4905,6 +4946,7 @@ void Chainstate::LoadExternalBlockFile(
                 LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
             }
         }
+        if (!batch.empty()) process_batch();
     } catch (const std::runtime_error& e) {
         AbortNode(std::string("System error: ") + e.what());
     }
@@ -18,6 +18,7 @@
 #include <kernel/chainparams.h>
 #include <kernel/chainstatemanager_opts.h>
 #include <kernel/cs_main.h> // IWYU pragma: export
+#include <node/blockprefetch.h>
 #include <node/blockstorage.h>
 #include <policy/feerate.h>
 #include <policy/packages.h>
@@ -85,6 +86,10 @@ bool ExtractIndexInfo(const CScript *pScript, int &scriptType, std::vector<uint8
 static const int MAX_SCRIPTCHECK_THREADS = 15;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of dedicated header proof-of-work checking threads allowed */
+static const int MAX_POWCHECK_THREADS = 15;
+/** -powthreads default (number of header proof-of-work checking threads, 0 = auto) */
+static const int DEFAULT_POWCHECK_THREADS = 0;
 /** Default for -stopatheight */
 static const int DEFAULT_STOPATHEIGHT = 0;
 /** Block files containing a block-height within MIN_BLOCKS_TO_KEEP of ActiveChain().Tip() will not be pruned. */
@@ -120,6 +125,10 @@ extern const std::vector<std::string> CHECKLEVEL_DOC;
 void StartScriptCheckWorkerThreads(int threads_num);
 /** Stop all of the script checking worker threads */
 void StopScriptCheckWorkerThreads();
+/** Run instances of header proof-of-work checking worker threads */
+void StartPoWCheckWorkerThreads(int threads_num);
+/** Stop all of the header proof-of-work checking worker threads */
+void StopPoWCheckWorkerThreads();
 
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams);
 
@@ -379,7 +388,8 @@ bool TestBlockValidity(BlockValidationState& state,
                        bool fCheckPOW = true,
                        bool fCheckMerkleRoot = true) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
-/** Check with the proof of work on each blockheader matches the value in nBits */
+/** Check with the proof of work on each blockheader matches the value in nBits.
+ *  Batches are hashed on the -powthreads worker pool when it is running. */
 bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams);
 
 /** Return the sum of the work on a given set of headers */
@@ -530,6 +540,11 @@ protected:
     //! is set to true on the snapshot chainstate.
     bool m_disabled GUARDED_BY(::cs_main) {false};
 
+    /* YespowerSugar */
+    //! Reads and checks the blocks that ActivateBestChainStep is about to
+    //! connect from disk ahead of ConnectTip. Created on first use.
+    std::unique_ptr<node::BlockPrefetcher> m_block_prefetcher GUARDED_BY(::cs_main);
+
 public:
     //! Reference to a BlockManager instance which itself is shared across all
     //! Chainstate instances.
@@ -800,6 +815,9 @@ public:
 private:
     bool ActivateBestChainStep(BlockValidationState& state, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
     bool ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
+    /** Queue the blocks of vpindexToConnect (in descending height order) that
+     *  ConnectTip will read from disk on m_block_prefetcher. */
+    void PrefetchBlocks(const std::vector<CBlockIndex*>& vpindexToConnect, const CBlockIndex* pindex_cached) EXCLUSIVE_LOCKS_REQUIRED(cs_main); /* YespowerSugar */
 
     void InvalidBlockFound(CBlockIndex* pindex, const BlockValidationState& state) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     CBlockIndex* FindMostWorkChain() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -47,6 +47,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
+    factories["pubaddressdelta"] = CZMQAbstractNotifier::Create<CZMQPublishAddressDeltaNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -139,8 +140,19 @@ void TryForEachAndRemoveFailed(std::list<std::unique_ptr<CZMQAbstractNotifier>>&
 
 } // anonymous namespace
 
+// Address deltas are logged by the mempool and by the insight index, whose
+// own notifications are handled before the next ones reach this interface.
+void CZMQNotificationInterface::NotifyAddressDeltas()
+{
+    TryForEachAndRemoveFailed(notifiers, [](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyAddressDeltas();
+    });
+}
+
 void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
 {
+    NotifyAddressDeltas();
+
     if (fInitialDownload || pindexNew == pindexFork) // In IBD or blocks were disconnected without any new ones
         return;
 
@@ -156,6 +168,8 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     TryForEachAndRemoveFailed(notifiers, [&tx, mempool_sequence](CZMQAbstractNotifier* notifier) {
         return notifier->NotifyTransaction(tx) && notifier->NotifyTransactionAcceptance(tx, mempool_sequence);
     });
+
+    NotifyAddressDeltas();
 }
 
 void CZMQNotificationInterface::TransactionRemovedFromMempool(const CTransactionRef& ptx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
@@ -181,6 +195,8 @@ void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBloc
     TryForEachAndRemoveFailed(notifiers, [pindexConnected](CZMQAbstractNotifier* notifier) {
         return notifier->NotifyBlockConnect(pindexConnected);
     });
+
+    NotifyAddressDeltas();
 }
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
@@ -196,6 +212,8 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     TryForEachAndRemoveFailed(notifiers, [pindexDisconnected](CZMQAbstractNotifier* notifier) {
         return notifier->NotifyBlockDisconnect(pindexDisconnected);
     });
+
+    NotifyAddressDeltas();
 }
 
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
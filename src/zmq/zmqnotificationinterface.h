@@ -39,6 +39,9 @@ protected:
 private:
     CZMQNotificationInterface();
 
+    /** Publish the address deltas logged since the last notification. */
+    void NotifyAddressDeltas();
+
     void* pcontext{nullptr};
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
 };
@@ -4,6 +4,7 @@
 
 #include <zmq/zmqpublishnotifier.h>
 
+#include <addressnotifier.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <crypto/common.h>
@@ -29,6 +30,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <map>
 #include <optional>
 #include <string>
@@ -48,6 +50,7 @@ static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
+static const char *MSG_ADDRESSDELTA = "addressdelta";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -269,6 +272,21 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
 
+bool CZMQPublishAddressDeltaNotifier::NotifyAddressDeltas()
+{
+    if (!g_address_notifier) return true;
+    std::vector<AddressDeltaEvent> events;
+    g_address_notifier->GetEvents(m_last_sequence, std::numeric_limits<size_t>::max(), events);
+    for (const AddressDeltaEvent& event : events) {
+        LogPrint(BCLog::ZMQ, "Publish addressdelta %s:%u to %s\n", event.txid.GetHex(), event.index, this->address);
+        DataStream ss{};
+        ss << event;
+        if (!SendZmqMessage(MSG_ADDRESSDELTA, ss.data(), ss.size())) return false;
+        m_last_sequence = event.sequence;
+    }
+    return true;
+}
+
 // Helper function to send a 'sequence' topic message with the following structure:
 //    <32-byte hash> | <1-byte label> | <8-byte LE sequence> (optional)
 static bool SendSequenceMsg(CZMQAbstractPublishNotifier& notifier, uint256 hash, char label, std::optional<uint64_t> sequence = {})
@@ -56,6 +56,15 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishAddressDeltaNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    uint64_t m_last_sequence{0}; //!< last address delta event published
+
+public:
+    bool NotifyAddressDeltas() override;
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public: